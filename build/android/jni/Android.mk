@@ -12,7 +12,8 @@ LOCAL_MODULE := musicxml2
 LOCAL_SRC_FILES         := $(subst $(LOCAL_PATH)/,,$(wildcard $(SRC)/[^a]*/*.cpp))
 LOCAL_EXPORT_C_INCLUDES := $(addprefix $(SRC)/, interface)
 LOCAL_C_INCLUDES        := $(subst $(LOCAL_PATH)/../,,$(wildcard $(SRC)/[^.]*/))
-LOCAL_CPPFLAGS          := -Dandroid -frtti
+LOCAL_CPPFLAGS          := -Dandroid -frtti -DHAVE_ZLIB
+LOCAL_LDLIBS            := -lz
 
 include $(BUILD_SHARED_LIBRARY)
 
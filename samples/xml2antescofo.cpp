@@ -43,7 +43,7 @@ int main(int argc, char *argv[])
 	else
 		err = musicxmlfile2antescofo(file, generateBars, cout);
 	if (err) {
-		cout << "conversion failed" << endl;
+		cerr << "conversion failed" << endl;
 	}
 	return 0;
 }
@@ -11,6 +11,7 @@
 # pragma warning (disable : 4786)
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 #include <iostream>
 
@@ -18,6 +19,7 @@
 #include "xmlfile.h"
 #include "xmlreader.h"
 #include "midicontextvisitor.h"
+#include "smfwriter.h"
 #include "unrolled_xml_tree_browser.h"
 
 using namespace std;
@@ -30,30 +32,46 @@ class mymidiwriter : public midiwriter {
 		virtual ~mymidiwriter() {}
 		
 		virtual void startPart (int instrCount) 
-			{ cout << "startPart with " << instrCount << " instrument(s)" << endl; }
+			{ cout << "startPart with " << instrCount << " instrument(s)" << "\n"; }
 		virtual void newInstrument (std::string instrName, int chan=-1)
-			{ cout << "newInstrument \"" << instrName << "\" on chan " << chan << endl; }
+			{ cout << "newInstrument \"" << instrName << "\" on chan " << chan << "\n"; }
 		virtual void endPart (long date)
-			{ cout << date << " endPart" << endl; }
+			{ cout << date << " endPart" << "\n"; }
 
 		virtual void newNote (long date, int chan, float pitch, int vel, int dur)
-			{ cout << date << " newNote [" << chan << "," << pitch << "," << vel << "," << dur << "]" << endl; }
+			{ cout << date << " newNote [" << chan << "," << pitch << "," << vel << "," << dur << "]" << "\n"; }
 		virtual void tempoChange (long date, int bpm)
-			{ cout << date << " tempoChange " << bpm << endl; }
+			{ cout << date << " tempoChange " << bpm << "\n"; }
 		virtual void pedalChange (long date, pedalType t, int value)
-			{ cout << date << " pedalChange type " << t << " val " << value << endl; }
+			{ cout << date << " pedalChange type " << t << " val " << value << "\n"; }
 
 		virtual void volChange (long date, int chan, int vol)
-			{ cout << date << " volChange chan  " << chan << " vol " << vol << endl; }
+			{ cout << date << " volChange chan  " << chan << " vol " << vol << "\n"; }
 		virtual void bankChange (long date, int chan, int bank)
-			{ cout << date << " bankChange chan " << chan << " bank " << bank << endl; }
+			{ cout << date << " bankChange chan " << chan << " bank " << bank << "\n"; }
 		virtual void progChange (long date, int chan, int prog)
-			{ cout << date << " progChange chan " << chan << " prog " << prog << endl; }
+			{ cout << date << " progChange chan " << chan << " prog " << prog << "\n"; }
 };
 
+//_______________________________________________________________________________
+static void usage() {
+	cerr << "usage: xml2midi [-o <midi file>] <musicxml file>" << endl;
+	cerr << "       reads stdin when <musicxml file> is '-'" << endl;
+	cerr << "       option: -o writes a standard MIDI file instead of the text events" << endl;
+	exit(1);
+}
+
 //_______________________________________________________________________________
 int main(int argc, char *argv[]) {
+	const char * midifile = 0;
 	char * file = argv[1];
+	if (argc == 4) {
+		if (strcmp(argv[1], "-o")) usage();
+		midifile = argv[2];
+		file = argv[3];
+	}
+	else if (argc > 2) usage();
+
 	xmlreader r;
 	SXMLFile xmlfile;
 	if ((argc > 1) && strcmp(file, "-"))
@@ -63,10 +81,16 @@ int main(int argc, char *argv[]) {
 	if (xmlfile) {
 		Sxmlelement st = xmlfile->elements();
 		if (st) {
-			mymidiwriter writer;
-			midicontextvisitor v(480, &writer);
+			mymidiwriter textwriter;
+			smfwriter smf(480);
+			midiwriter * writer = midifile ? (midiwriter*)&smf : (midiwriter*)&textwriter;
+			midicontextvisitor v(480, writer);
 			unrolled_xml_tree_browser browser(&v);
 			browser.browse(*st);
+			if (midifile && !smf.write (midifile)) {
+				cerr << "can't write " << midifile << endl;
+				return 1;
+			}
 		}
 	}
 	return 0;
@@ -0,0 +1,46 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It converts a MusicXML file to a compressed MusicXML (.mxl) file.
+
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <iostream>
+
+#include "mxlfile.h"
+#include "xmlfile.h"
+#include "xmlreader.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+static void usage()
+{
+	cerr << "usage: xml2mxl <musicxml file> <mxl file> [level]" << endl;
+	cerr << "       level: the compression level, from 0 (no compression) to 9" << endl;
+	exit(1);
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[])
+{
+	if ((argc < 3) || (argc > 4)) usage();
+
+	mxlwriter w;
+	if ((argc == 4) && !w.setLevel (atoi(argv[3]))) usage();
+
+	xmlreader r;
+	SXMLFile file = r.read (argv[1]);
+	if (!file) return 1;
+	return w.write (file, argv[2]) ? 0 : 1;
+}
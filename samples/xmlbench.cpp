@@ -0,0 +1,344 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+#include "libmusicxml.h"
+#include "clonevisitor.h"
+#include "footprint.h"
+#include "midicontextvisitor.h"
+#include "transposition.h"
+#include "unrolled_xml_tree_browser.h"
+#include "xml.h"
+#include "xml2guidovisitor.h"
+#include "xml_tree_browser.h"
+#include "xmlfile.h"
+#include "xmlreader.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+// allocations accounting: the global operators are replaced for the whole process
+//_______________________________________________________________________________
+static unsigned long gAllocations = 0;
+static unsigned long gAllocatedBytes = 0;
+
+#if __cplusplus >= 201103L
+# define THROWS_BAD_ALLOC
+# define NOTHROW	noexcept
+#else
+# define THROWS_BAD_ALLOC	throw(std::bad_alloc)
+# define NOTHROW	throw()
+#endif
+
+void* operator new (size_t size) THROWS_BAD_ALLOC
+{
+	gAllocations++;
+	gAllocatedBytes += size;
+	void* p = malloc (size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void* operator new[] (size_t size) THROWS_BAD_ALLOC	{ return operator new (size); }
+void operator delete (void* p) NOTHROW				{ free (p); }
+void operator delete[] (void* p) NOTHROW			{ free (p); }
+
+//_______________________________________________________________________________
+// the peak resident set size in kb, 0 when not available
+static long peakRSS ()
+{
+#ifdef WIN32
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage (RUSAGE_SELF, &usage)) return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;		// bytes on mac os
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static double seconds ()	{ return double(clock()) / CLOCKS_PER_SEC; }
+
+//_______________________________________________________________________________
+// visitors and writers doing nothing
+//_______________________________________________________________________________
+class noopvisitor : public visitor<Sxmlelement>
+{
+	public:
+		virtual void visitStart (Sxmlelement& elt) {}
+		virtual void visitEnd   (Sxmlelement& elt) {}
+};
+
+class noopmidiwriter : public midiwriter {
+	public:
+		virtual void startPart (int instrCount) {}
+		virtual void newInstrument (std::string instrName, int chan=-1) {}
+		virtual void endPart (long date) {}
+		virtual void newNote (long date, int chan, float pitch, int vel, int dur) {}
+		virtual void tempoChange (long date, int bpm) {}
+		virtual void pedalChange (long date, pedalType t, int value) {}
+		virtual void volChange (long date, int chan, int vol) {}
+		virtual void bankChange (long date, int chan, int bank) {}
+		virtual void progChange (long date, int chan, int prog) {}
+};
+
+// a stream buffer that counts and drops its output
+class countbuf : public streambuf {
+	public:
+		unsigned long fCount;
+				 countbuf() : fCount(0) {}
+	protected:
+		virtual int overflow (int c)		{ if (c != EOF) fCount++; return c == EOF ? 0 : c; }
+		virtual streamsize xsputn (const char* s, streamsize n)	{ fCount += (unsigned long)n; return n; }
+};
+
+//_______________________________________________________________________________
+// stages
+//_______________________________________________________________________________
+enum { kParse, kWalk, kGuido, kMidi, kTranspose, kClone, kPrint, kStages };
+static const char* gStageNames[kStages] = { "parse", "walk", "xml2guido", "midi", "transpose", "clone", "print" };
+
+typedef struct {
+	double			fTime;
+	unsigned long	fBytes;				// the input bytes processed
+	unsigned long	fNodes;				// the tree nodes processed
+	unsigned long	fOutput;			// the output bytes, when relevant
+	unsigned long	fAllocations;
+	unsigned long	fAllocatedBytes;
+	long			fPeakRSS;			// the process peak RSS after the stage
+} stage;
+
+static unsigned long countNodes (const Sxmlelement& elt)
+{
+	unsigned long n = 1;
+	for (ctree<xmlelement>::literator i = elt->lbegin(); i != elt->lend(); i++)
+		n += countNodes (*i);
+	return n;
+}
+
+static unsigned long fileSize (const char* file)
+{
+	ifstream f (file, ios::in | ios::binary | ios::ate);
+	return f.is_open() ? (unsigned long)f.tellg() : 0;
+}
+
+static Sxmlelement clone (const Sxmlelement& elt)
+{
+	clonevisitor cv;
+	xml_tree_browser browser(&cv);
+	browser.browse (*elt);
+	return cv.clone();
+}
+
+//_______________________________________________________________________________
+// runs a stage: the time, allocations and output are accumulated
+class stagerun {
+	stage&			fStage;
+	double			fStart;
+	unsigned long	fAllocations, fAllocatedBytes;
+	public:
+		stagerun (stage& s) : fStage(s) {
+			fAllocations = gAllocations;
+			fAllocatedBytes = gAllocatedBytes;
+			fStart = seconds();
+		}
+		void done (unsigned long bytes, unsigned long nodes, unsigned long output=0) {
+			fStage.fTime += seconds() - fStart;
+			fStage.fAllocations += gAllocations - fAllocations;
+			fStage.fAllocatedBytes += gAllocatedBytes - fAllocatedBytes;
+			fStage.fBytes += bytes;
+			fStage.fNodes += nodes;
+			fStage.fOutput += output;
+			fStage.fPeakRSS = peakRSS();
+		}
+};
+
+//_______________________________________________________________________________
+static bool bench (const char* file, int repeat, stage* stages, footprint& fp)
+{
+	unsigned long size = fileSize (file);
+	SXMLFile xml;
+	for (int i = 0; i < repeat; i++) {
+		stagerun run (stages[kParse]);
+		xmlreader r;
+		xml = r.read (file);
+		if (!xml || !xml->elements()) return false;
+		run.done (size, 0);
+	}
+	// the nodes are counted out of the parse time
+	Sxmlelement elts = xml->elements();
+	unsigned long nodes = countNodes (elts);
+	stages[kParse].fNodes += nodes * repeat;
+	fp.add (xml);
+
+	for (int i = 0; i < repeat; i++) {
+		stagerun run (stages[kWalk]);
+		noopvisitor v;
+		xml_tree_browser browser(&v);
+		browser.browse (*elts);
+		run.done (size, nodes);
+	}
+	for (int i = 0; i < repeat; i++) {
+		countbuf buf;
+		ostream out (&buf);
+		stagerun run (stages[kGuido]);
+		xml2guidovisitor v(true, true, true);
+		v.convert (elts, out);
+		run.done (size, nodes, buf.fCount);
+	}
+	for (int i = 0; i < repeat; i++) {
+		stagerun run (stages[kMidi]);
+		noopmidiwriter writer;
+		midicontextvisitor v(480, &writer);
+		unrolled_xml_tree_browser browser(&v);
+		browser.browse (*elts);
+		run.done (size, nodes);
+	}
+	for (int i = 0; i < repeat; i++) {
+		// the transposition modifies the tree and visits typed elements only:
+		// a clone is untyped, the file is read again
+		xmlreader r;
+		SXMLFile copy = r.read (file);
+		if (!copy || !copy->elements()) return false;
+		stagerun run (stages[kTranspose]);
+		transposition t(3);
+		xml_tree_browser browser(&t);
+		browser.browse (*copy->elements());
+		run.done (size, nodes);
+	}
+	for (int i = 0; i < repeat; i++) {
+		stagerun run (stages[kClone]);
+		Sxmlelement copy = clone (elts);
+		run.done (size, nodes);
+	}
+	for (int i = 0; i < repeat; i++) {
+		countbuf buf;
+		ostream out (&buf);
+		stagerun run (stages[kPrint]);
+		xml->print (out);
+		run.done (size, nodes, buf.fCount);
+	}
+	return true;
+}
+
+//_______________________________________________________________________________
+static string escape (const string& str)
+{
+	string out;
+	for (size_t i = 0; i < str.size(); i++) {
+		char c = str[i];
+		if ((c == '"') || (c == '\\')) out += '\\';
+		if ((unsigned char)c < 0x20) out += ' ';
+		else out += c;
+	}
+	return out;
+}
+
+static double rate (double value, double time)	{ return (time > 0) ? value / time : 0; }
+
+static void report (ostream& out, int repeat, const vector<string>& files, const vector<string>& failed, unsigned long bytes, unsigned long nodes, const footprint& fp, const stage* stages)
+{
+	out << "{\n"
+		<< "  \"library\": \"" << musicxmllibVersionStr() << "\",\n"
+		<< "  \"repeat\": " << repeat << ",\n"
+		<< "  \"files\": " << files.size() << ",\n"
+		<< "  \"bytes\": " << bytes << ",\n"
+		<< "  \"nodes\": " << nodes << ",\n"
+		<< "  \"failed\": [";
+	for (size_t i = 0; i < failed.size(); i++)
+		out << (i ? ", " : "") << "\"" << escape(failed[i]) << "\"";
+	out << "],\n"
+		<< "  \"peak_rss_kb\": " << peakRSS() << ",\n"
+		<< "  \"footprint\": ";
+	fp.print (out);
+	out << ",\n"
+		<< "  \"stages\": [\n";
+	for (int i = 0; i < kStages; i++) {
+		const stage& s = stages[i];
+		out << "    { \"name\": \"" << gStageNames[i] << "\""
+			<< ", \"seconds\": " << s.fTime
+			<< ", \"mb_per_s\": " << rate (s.fBytes / (1024. * 1024.), s.fTime)
+			<< ", \"nodes_per_s\": " << rate (s.fNodes, s.fTime)
+			<< ", \"output_bytes\": " << s.fOutput
+			<< ", \"allocations\": " << s.fAllocations
+			<< ", \"allocated_bytes\": " << s.fAllocatedBytes
+			<< ", \"peak_rss_kb\": " << s.fPeakRSS
+			<< " }" << ((i < kStages - 1) ? "," : "") << "\n";
+	}
+	out << "  ]\n}" << endl;
+}
+
+//_______________________________________________________________________________
+static void usage() {
+	cerr << "usage: xmlbench [-r <repeat>] [-o <json file>] <musicxml files>" << endl;
+	cerr << "       runs the parse, walk, xml2guido, midi, transpose, clone and print stages" << endl;
+	cerr << "       over the files and reports the stages performance in json format" << endl;
+	cerr << "       option: -r runs each stage <repeat> times per file (default 1)" << endl;
+	cerr << "       option: -o writes the report to <json file> instead of stdout" << endl;
+	exit(1);
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[]) {
+	int repeat = 1;
+	const char* outfile = 0;
+	vector<string> files;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-r") && (i + 1 < argc)) repeat = atoi (argv[++i]);
+		else if (!strcmp(argv[i], "-o") && (i + 1 < argc)) outfile = argv[++i];
+		else if (argv[i][0] == '-') usage();
+		else files.push_back (argv[i]);
+	}
+	if (files.empty() || (repeat < 1)) usage();
+
+	stage stages[kStages];
+	memset (stages, 0, sizeof(stages));
+	vector<string> failed;
+	footprint fp;
+	unsigned long bytes = 0, nodes = 0;
+	for (vector<string>::const_iterator i = files.begin(); i != files.end(); i++) {
+		unsigned long parsed = stages[kParse].fNodes;
+		if (bench (i->c_str(), repeat, stages, fp)) {
+			bytes += fileSize (i->c_str());
+			nodes += (stages[kParse].fNodes - parsed) / repeat;
+		}
+		else failed.push_back (*i);
+	}
+
+	if (outfile) {
+		ofstream out (outfile);
+		if (!out.is_open()) {
+			cerr << "can't open file " << outfile << endl;
+			return 1;
+		}
+		report (out, repeat, files, failed, bytes, nodes, fp, stages);
+	}
+	else report (cout, repeat, files, failed, bytes, nodes, fp, stages);
+	return failed.empty() ? 0 : 1;
+}
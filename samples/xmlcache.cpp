@@ -0,0 +1,122 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It checks the print cache: a tree printed with the cache after some
+  modifications must be printed as without the cache.
+
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "elements.h"
+#include "musicxmlfactory.h"
+#include "xml.h"
+#include "xmlfile.h"
+#include "xmlreader.h"
+#include "xmlvisitor.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+static string print (const Sxmlelement& elt, xmlprintcache* cache)
+{
+	ostringstream s;
+	xmlvisitor v(s, cache);
+	v.print (elt);
+	return s.str();
+}
+
+// a tree is always printed with the same cache
+static bool check (const Sxmlelement& elt, xmlprintcache& cache, const char* what)
+{
+	string cached = print (elt, &cache);
+	if (cached == print (elt, 0)) return true;
+	cerr << what << ": the cached print differs" << endl;
+	return false;
+}
+
+//_______________________________________________________________________________
+// modifies one leaf out of 'step' leaves with a value
+static void modify (const Sxmlelement& elt, int step, int& count)
+{
+	if (elt->size()) {
+		for (ctree<xmlelement>::literator i = elt->lbegin(); i != elt->lend(); i++)
+			modify (*i, step, count);
+	}
+	else if (!elt->getValue().empty() && ((++count % step) == 0))
+		elt->setValue (elt->getValue() + " ");
+}
+
+static bool checkfile (const char* file)
+{
+	xmlreader r;
+	SXMLFile xml = r.read (file);
+	if (!xml) {
+		cerr << file << ": read failed" << endl;
+		return false;
+	}
+	Sxmlelement root = xml->elements();
+	xmlprintcache cache;
+	if (!check (root, cache, file)) return false;
+	int steps[] = { 97, 13, 3 };
+	for (int i = 0; i < 3; i++) {
+		int count = 0;
+		modify (root, steps[i], count);
+		if (!check (root, cache, file)) return false;
+	}
+	return true;
+}
+
+//_______________________________________________________________________________
+// the time-modification element of a tuplet is shared by the tuplet notes:
+// its modification must be printed in every note
+static bool checkshared ()
+{
+	musicxmlfactory f;
+	Sxmlelement measure = f.newmeasure (1);
+	vector<Sxmlelement> notes;
+	for (int i = 0; i < 3; i++)
+		notes.push_back (f.newnote ("C", 0, 4, 2, "eighth"));
+	f.maketuplet (3, 2, notes);
+	f.add (measure, notes);
+	xmlprintcache cache;
+	if (!check (measure, cache, "shared element")) return false;
+
+	Sxmlelement timemod = *notes[0]->find (k_time_modification);
+	Sxmlelement actual = *timemod->find (k_actual_notes);
+	actual->setValue (5);
+	if (!check (measure, cache, "shared element")) return false;
+
+	string text = print (measure, &cache);
+	int n = 0;
+	for (size_t pos = text.find ("<actual-notes>5<"); pos != string::npos; pos = text.find ("<actual-notes>5<", pos + 1))
+		n++;
+	if (n != 3) {
+		cerr << "shared element: the modification is printed in " << n << " notes out of 3" << endl;
+		return false;
+	}
+	return true;
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[])
+{
+	int failed = checkshared() ? 0 : 1;
+	for (int i = 1; i < argc; i++)
+		if (!checkfile (argv[i])) failed++;
+	if (failed) cerr << failed << " check(s) failed" << endl;
+	return failed ? 1 : 0;
+}
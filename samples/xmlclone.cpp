@@ -19,9 +19,8 @@
 #include "xmlfile.h"
 #include "xmlreader.h"
 #include "clonevisitor.h"
-#include "unrolled_clonevisitor.h"
 #include "xml_tree_browser.h"
-#include "unrolled_xml_tree_browser.h"
+#include "unrolled_view.h"
 
 using namespace std;
 using namespace MusicXML2;
@@ -51,10 +50,8 @@ int main(int argc, char *argv[]) {
 	if (file) {
 		Sxmlelement elts = file->elements();
 		if (unroll) {
-			unrolled_clonevisitor uv;
-			unrolled_xml_tree_browser tb(&uv);
-			tb.browse (*elts);
-			elts = uv.clone();
+			Sunrolled_view view = unrolled_view::create (elts);
+			elts = view->materialize();
 		}
 		else {
 			clonevisitor cv;
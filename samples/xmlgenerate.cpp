@@ -0,0 +1,89 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It generates synthetic scores of any size, e.g. for scalability benchmarks.
+
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+
+#include "scoregenerator.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+static void usage() {
+	cerr << "usage: xmlgenerate [options]" << endl;
+	cerr << "       writes a synthetic MusicXML score to the standard output" << endl;
+	cerr << "       options: -seed <n>      the random seed (default 1)" << endl;
+	cerr << "                -parts <n>     the parts count (default 1)" << endl;
+	cerr << "                -staves <n>    the staves count per part (default 1)" << endl;
+	cerr << "                -voices <n>    the voices count per staff (default 1)" << endl;
+	cerr << "                -measures <n>  the measures count (default 20)" << endl;
+	cerr << "                -chords <n>    the percentage of chords (default 0)" << endl;
+	cerr << "                -tuplets <n>   the percentage of beats that are triplets (default 0)" << endl;
+	cerr << "                -repeats <n>   repeats the sections of <n> measures (default 0: none)" << endl;
+	cerr << "                -jumps         adds segno, coda and dal segno jumps" << endl;
+	cerr << "                -lyrics        adds lyrics to the first voice" << endl;
+	cerr << "                -memory        builds the whole score in memory before printing" << endl;
+	cerr << "                -o <file>      writes the score to <file>" << endl;
+	exit(1);
+}
+
+static int intopt (int argc, char *argv[], int& i) {
+	if (i + 1 >= argc) usage();
+	int n = atoi (argv[++i]);
+	if (n < 0) usage();
+	return n;
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[]) {
+	scoregenerator::settings s = scoregenerator::defaults();
+	bool memory = false;
+	const char* outfile = 0;
+	for (int i = 1; i < argc; i++) {
+		const char* opt = argv[i];
+		if (!strcmp(opt, "-seed"))			s.fSeed = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-parts"))	s.fParts = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-staves"))	s.fStaves = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-voices"))	s.fVoices = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-measures"))	s.fMeasures = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-chords"))	s.fChords = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-tuplets"))	s.fTuplets = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-repeats"))	s.fRepeats = intopt (argc, argv, i);
+		else if (!strcmp(opt, "-jumps"))	s.fJumps = true;
+		else if (!strcmp(opt, "-lyrics"))	s.fLyrics = true;
+		else if (!strcmp(opt, "-memory"))	memory = true;
+		else if (!strcmp(opt, "-o") && (i + 1 < argc)) outfile = argv[++i];
+		else usage();
+	}
+	if ((s.fStaves < 1) || (s.fVoices < 1)) usage();
+
+	ofstream file;
+	if (outfile) {
+		file.open (outfile);
+		if (!file.is_open()) {
+			cerr << "can't open file " << outfile << endl;
+			return 1;
+		}
+	}
+	ostream& out = outfile ? file : cout;
+	scoregenerator generator (s);
+	if (memory) generator.score()->print (out);
+	else generator.write (out);
+	out << endl;
+	return 0;
+}
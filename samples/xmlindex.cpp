@@ -0,0 +1,182 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It builds and queries an index of a corpus of scores.
+
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+# include <io.h>
+#else
+# include <dirent.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "corpusindex.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+static void usage() {
+	cerr << "usage: xmlindex build <index> [-j <workers>] <directories or files>" << endl;
+	cerr << "       xmlindex query <index> [options]" << endl;
+	cerr << "       build: indexes the MusicXML files (.xml, .musicxml, .mxl) of the directories," << endl;
+	cerr << "              an existing index is updated: the unchanged files are not parsed again" << endl;
+	cerr << "              -j <workers>    the count of workers (default 4)" << endl;
+	cerr << "       query: prints the paths of the matching scores" << endl;
+	cerr << "              -composer <s>   the composer contains <s>" << endl;
+	cerr << "              -title <s>      the title contains <s>" << endl;
+	cerr << "              -instrument <s> a part or instrument name contains <s>" << endl;
+	cerr << "              -key <fifths>   the first key signature" << endl;
+	cerr << "              -mode <mode>    the first key mode" << endl;
+	cerr << "              -time <b/t>     the first time signature, e.g. 3/4" << endl;
+	cerr << "              -range <low> <high>   the notes MIDI pitches range" << endl;
+	cerr << "              -measures <min> <max> the measures count" << endl;
+	cerr << "              -json           prints the matching scores features in json format" << endl;
+	exit(1);
+}
+
+//_______________________________________________________________________________
+static bool isMusicXML (const string& name)
+{
+	const char* ext[] = { ".xml", ".musicxml", ".mxl", 0 };
+	for (int i = 0; ext[i]; i++) {
+		size_t n = strlen(ext[i]);
+		if ((name.size() > n) && (name.compare (name.size() - n, n, ext[i]) == 0))
+			return true;
+	}
+	return false;
+}
+
+static void walk (const string& path, vector<string>& files)
+{
+	struct stat s;
+	if (stat (path.c_str(), &s)) return;
+	if (!(s.st_mode & S_IFDIR)) {
+		files.push_back (path);
+		return;
+	}
+#ifdef WIN32
+	struct _finddata_t entry;
+	intptr_t h = _findfirst ((path + "\\*").c_str(), &entry);
+	if (h == -1) return;
+	do {
+		string name = entry.name;
+		if ((name == ".") || (name == "..")) continue;
+		string sub = path + "\\" + name;
+		if (entry.attrib & _A_SUBDIR) walk (sub, files);
+		else if (isMusicXML (name)) files.push_back (sub);
+	} while (_findnext (h, &entry) == 0);
+	_findclose (h);
+#else
+	DIR* dir = opendir (path.c_str());
+	if (!dir) return;
+	struct dirent* entry;
+	while ((entry = readdir (dir))) {
+		string name = entry->d_name;
+		if ((name == ".") || (name == "..")) continue;
+		string sub = path + "/" + name;
+		if (stat (sub.c_str(), &s)) continue;
+		if (s.st_mode & S_IFDIR) walk (sub, files);
+		else if (isMusicXML (name)) files.push_back (sub);
+	}
+	closedir (dir);
+#endif
+}
+
+//_______________________________________________________________________________
+static int build (const char* index, int argc, char *argv[])
+{
+	int workers = 4;
+	vector<string> files;
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "-j") && (i + 1 < argc)) workers = atoi (argv[++i]);
+		else if (argv[i][0] == '-') usage();
+		else walk (argv[i], files);
+	}
+	if (files.empty() || (workers < 1)) usage();
+
+	corpusindex previous;
+	previous.open (index);
+	vector<scorefeatures> scores;
+	corpusindex::updatestats s = previous.update (files, workers, scores);
+	previous.close();
+	if (!corpusindex::write (index, scores)) {
+		cerr << "can't write index " << index << endl;
+		return 1;
+	}
+	cerr << index << ": " << scores.size() << " scores - "
+		<< s.fUnchanged << " unchanged, " << s.fSameContent << " same content, "
+		<< s.fParsed << " parsed, " << s.fFailed << " failed" << endl;
+	return 0;
+}
+
+static int intarg (int argc, char *argv[], int& i) {
+	if (i + 1 >= argc) usage();
+	return atoi (argv[++i]);
+}
+
+static const char* strarg (int argc, char *argv[], int& i) {
+	if (i + 1 >= argc) usage();
+	return argv[++i];
+}
+
+static int query (const char* index, int argc, char *argv[])
+{
+	corpusquery q;
+	bool json = false;
+	for (int i = 0; i < argc; i++) {
+		const char* opt = argv[i];
+		if (!strcmp(opt, "-composer"))			q.fComposer = strarg (argc, argv, i);
+		else if (!strcmp(opt, "-title"))		q.fTitle = strarg (argc, argv, i);
+		else if (!strcmp(opt, "-instrument"))	q.fInstrument = strarg (argc, argv, i);
+		else if (!strcmp(opt, "-key"))			q.fFifths = intarg (argc, argv, i);
+		else if (!strcmp(opt, "-mode"))			q.fMode = strarg (argc, argv, i);
+		else if (!strcmp(opt, "-time"))			q.fTime = strarg (argc, argv, i);
+		else if (!strcmp(opt, "-range"))		{ q.fLowest = intarg (argc, argv, i); q.fHighest = intarg (argc, argv, i); }
+		else if (!strcmp(opt, "-measures"))		{ q.fMinMeasures = intarg (argc, argv, i); q.fMaxMeasures = intarg (argc, argv, i); }
+		else if (!strcmp(opt, "-json"))			json = true;
+		else usage();
+	}
+
+	corpusindex ci;
+	if (!ci.open (index)) {
+		cerr << "can't open index " << index << endl;
+		return 1;
+	}
+	vector<unsigned long> rows;
+	ci.query (q, rows);
+	if (json) cout << "[";
+	for (size_t i = 0; i < rows.size(); i++) {
+		if (json) {
+			scorefeatures f;
+			ci.get (rows[i], f);
+			cout << (i ? ",\n  " : "\n  ");
+			corpusindex::print (cout, f);
+		}
+		else cout << ci.path (rows[i]) << endl;
+	}
+	if (json) cout << "\n]" << endl;
+	return 0;
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[]) {
+	if (argc < 3) usage();
+	if (!strcmp(argv[1], "build"))	return build (argv[2], argc - 3, &argv[3]);
+	if (!strcmp(argv[1], "query"))	return query (argv[2], argc - 3, &argv[3]);
+	usage();
+	return 1;
+}
@@ -0,0 +1,112 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It builds a melodic n-grams index of a set of scores and searches motifs.
+
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <iostream>
+#include <vector>
+
+#include "ngramindex.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+static void usage() {
+	cerr << "usage: xmlmotif build <index> [-n <length>] <musicxml files>" << endl;
+	cerr << "       xmlmotif query <index> [-rhythm] <notes>" << endl;
+	cerr << "       build: indexes the n-grams of <length> intervals of the files melodies (default 4)" << endl;
+	cerr << "       query: prints the occurrences of a motif, at least <length> + 1 notes" << endl;
+	cerr << "              a note is given as a MIDI pitch and an optional duration: <pitch>[:<duration>]" << endl;
+	cerr << "              -rhythm  matches the durations ratios too, the durations are then required" << endl;
+	exit(1);
+}
+
+//_______________________________________________________________________________
+static int build (const char* file, int argc, char *argv[])
+{
+	int length = 4;
+	vector<const char*> files;
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && (i + 1 < argc)) length = atoi (argv[++i]);
+		else if (argv[i][0] == '-') usage();
+		else files.push_back (argv[i]);
+	}
+	if (files.empty() || (length < 1)) usage();
+
+	ngramindex index (length);
+	for (size_t i = 0; i < files.size(); i++) {
+		if (!index.add (files[i]))
+			cerr << "can't read " << files[i] << endl;
+	}
+	if (!index.write (file)) {
+		cerr << "can't write index " << file << endl;
+		return 1;
+	}
+	cerr << file << ": " << index.scores() << " scores indexed" << endl;
+	return 0;
+}
+
+static int query (const char* file, int argc, char *argv[])
+{
+	bool rhythm = false;
+	vector<ngramindex::note> motif;
+	for (int i = 0; i < argc; i++) {
+		if (!strcmp(argv[i], "-rhythm")) rhythm = true;
+		else {
+			char* end;
+			ngramindex::note n;
+			n.fPitch = (float)strtod (argv[i], &end);
+			n.fDuration = (*end == ':') ? strtol (end + 1, &end, 10) : 0;
+			if ((end == argv[i]) || *end) usage();
+			motif.push_back (n);
+		}
+	}
+	for (size_t i = 0; rhythm && (i < motif.size()); i++) {
+		if (motif[i].fDuration <= 0) {
+			cerr << "-rhythm requires a positive duration for every note" << endl;
+			return 1;
+		}
+	}
+
+	ngramindex index;
+	if (!index.read (file)) {
+		cerr << "can't read index " << file << endl;
+		return 1;
+	}
+	vector<ngramindex::posting> matches;
+	clock_t start = clock();
+	if (!index.query (motif, rhythm, matches)) {
+		cerr << "the motif should have at least " << index.length() + 1 << " notes" << endl;
+		return 1;
+	}
+	double elapsed = double(clock() - start) / CLOCKS_PER_SEC;
+	for (size_t i = 0; i < matches.size(); i++) {
+		const ngramindex::posting& m = matches[i];
+		cout << index.score(m.fScore) << " part " << m.fPart + 1 << " voice " << m.fVoice << " measure " << m.fMeasure << endl;
+	}
+	cerr << matches.size() << " matches in " << elapsed * 1000 << " ms" << endl;
+	return 0;
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[]) {
+	if (argc < 3) usage();
+	if (!strcmp(argv[1], "build"))	return build (argv[2], argc - 3, &argv[3]);
+	if (!strcmp(argv[1], "query"))	return query (argv[2], argc - 3, &argv[3]);
+	usage();
+	return 1;
+}
@@ -9,6 +9,8 @@
   http://repmus.ircam.fr/antescofo
 */
 
+#include <sstream>
+
 #include "antescofowriter.h"
 
 
@@ -20,16 +22,84 @@ map<rational, measure_elt>::iterator antescofowriter::findNoteInVector(rational
 	map<rational, measure_elt>::iterator i;
 	if (((i = v_Notes.find(atbeat))) != v_Notes.end())
 		return i;
-	else { // if exact note doesn't exist, maybe a note, began before
-		for (i = v_Notes.begin(); i != v_Notes.end(); i++) {
-			if (i->second.m_pos <= atbeat // note could be before
-					&& i->second.m_pos + i->second.duration > atbeat)
-				return i;
+	else if (fLeaves) { // if exact note doesn't exist, maybe a note, began before
+		// in a beat that contains notes ending after atbeat
+		long last = beatIndex(atbeat);
+		if (last >= fLeaves) last = fLeaves - 1;
+		for (long b = firstEnd(1, 0, fLeaves - 1, 0, last, atbeat); b >= 0; b = firstEnd(1, 0, fLeaves - 1, b + 1, last, atbeat)) {
+			i = b ? v_Notes.lower_bound(rational(b)) : v_Notes.begin();
+			for (; (i != v_Notes.end()) && (beatIndex(i->first) == b) && !(i->first > atbeat); i++) {
+				if (i->second.m_pos <= atbeat // note could be before
+						&& i->second.m_pos + i->second.duration > atbeat)
+					return i;
+			}
 		}
 	}
 	return v_Notes.end();
 }
 
+//______________________________________________________________________________
+// the notes ends by beat
+// fEnds is a max segment tree: the leaves (at fLeaves + beat) are the max end of the
+// notes starting in a beat, the nodes are the max of their children
+#define kMaxBeats	(1 << 20)
+
+long antescofowriter::beatIndex(const rational& pos)
+{
+	long n = pos.getNumerator();
+	long d = pos.getDenominator();
+	if (d < 0) { n = -n; d = -d; }
+	if ((n <= 0) || (d == 0)) return 0;
+	long beat = n / d;
+	return (beat < kMaxBeats) ? beat : kMaxBeats - 1;
+}
+
+void antescofowriter::touch(map<rational, measure_elt>::const_iterator i)
+{
+	long b = beatIndex(i->first);
+	if (b >= fLeaves) {						// grows the tree
+		long leaves = fLeaves ? fLeaves : 1;
+		while (leaves <= b) leaves *= 2;
+		vector<rational> ends (2 * leaves);
+		for (long n = 0; n < fLeaves; n++)
+			ends[leaves + n] = fEnds[fLeaves + n];
+		for (long n = leaves - 1; n > 0; n--)
+			ends[n] = (ends[2*n] > ends[2*n+1]) ? ends[2*n] : ends[2*n+1];
+		fEnds.swap (ends);
+		fLeaves = leaves;
+	}
+	rational end = i->second.m_pos + i->second.duration;
+	end.rationalise();
+	for (long n = fLeaves + b; (n > 0) && (end > fEnds[n]); n /= 2)
+		fEnds[n] = end;
+}
+
+// gives the first beat in [from, to] where notes end after atbeat, -1 when none
+long antescofowriter::firstEnd(long node, long low, long high, long from, long to, const rational& atbeat) const
+{
+	if ((high < from) || (low > to) || !(fEnds[node] > atbeat)) return -1;
+	if (low == high) return low;
+	long mid = (low + high) / 2;
+	long b = firstEnd(2 * node, low, mid, from, to, atbeat);
+	return (b >= 0) ? b : firstEnd(2 * node + 1, mid + 1, high, from, to, atbeat);
+}
+
+void antescofowriter::indexMeasure(int nmeasure, const rational& pos)
+{
+	map<int, rational>::iterator i = measure2pos.find(nmeasure);
+	if ((i == measure2pos.end()) || (pos < i->second))
+		measure2pos[nmeasure] = pos;
+}
+
+map<rational, measure_elt>::iterator antescofowriter::findMeasure(int nmeasure)
+{
+	map<int, rational>::const_iterator m = measure2pos.find(nmeasure);
+	if (m == measure2pos.end()) return v_Notes.end();
+	map<rational, measure_elt>::iterator i = v_Notes.lower_bound(m->second);
+	if ((i == v_Notes.end()) || (i->second.nMeasure != nmeasure)) return v_Notes.end();
+	return i;
+}
+
 // search for beat&measure in measure2beat map, 
 // if does not exist
 //   //if prevmeasure has beat
@@ -70,101 +140,107 @@ rational antescofowriter::AddBeat(rational beat, int nmeasure) {
 // so if nmeasure>1 we suppose notes were added before,
 // and the curBeat in absolute beats can be found.
 void antescofowriter::AddNote(int type, float pitch, rational dur, float nmeasure, rational &curBeat, int flag_, string rehearsal) {
+	if (fFailed) return;
 	map<rational, measure_elt>::iterator i;
-	cout << "; Addnote(beat:"<<curBeat.getNumerator() << "/" << curBeat.getDenominator() << ", meas:" << nmeasure <<" pitch:"<<pitch << " dur:"<< dur.getNumerator()<<"/"<<dur.getDenominator() << " type:"<<  type << " bpm:"<<fBPM<<") ";
+	ANTESCOFO_LOG(*this, "; Addnote(beat:"<<curBeat.getNumerator() << "/" << curBeat.getDenominator() << ", meas:" << nmeasure <<" pitch:"<<pitch << " dur:"<< dur.getNumerator()<<"/"<<dur.getDenominator() << " type:"<<  type << " bpm:"<<fBPM<<") ");
 	//cout << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%" << endl; print(false);
 
-	cout << "AddBeat: beat:" << curBeat.toFloat() << " measure " << nmeasure << endl;
+	ANTESCOFO_LOG(*this, "AddBeat: beat:" << curBeat.toFloat() << " measure " << nmeasure << endl);
 	curBeat = AddBeat(curBeat, nmeasure);
-	cout << "AddBeat: ==> curBeat:" << curBeat.toFloat() << " measure " << nmeasure << endl;
+	ANTESCOFO_LOG(*this, "AddBeat: ==> curBeat:" << curBeat.toFloat() << " measure " << nmeasure << endl);
 #if 1
 	rational abs_curBeat(0);
 	if (nmeasure > 1 && curBeat.toFloat() == 1.) {
 		if (pitch == 0.)
 			return;
-		cerr << "AntescofoWriter: something went wrong with note beats, trying to figure out current beat from measure number." << endl;
-		for (map<rational, measure_elt>::const_iterator i = v_Notes.begin(); i != v_Notes.end(); i++) {
-			if (i->second.nMeasure == nmeasure) {
-				abs_curBeat = i->second.m_pos + curBeat - rational(1);
-				break;
-			}
-		}
+		ANTESCOFO_LOG(*this, "AntescofoWriter: something went wrong with note beats, trying to figure out current beat from measure number." << endl);
+		map<rational, measure_elt>::iterator m = findMeasure(nmeasure);
+		if (m != v_Notes.end())
+			abs_curBeat = m->second.m_pos + curBeat - rational(1);
 		if (abs_curBeat.getNumerator()) {
 			curBeat = abs_curBeat;
-			cout << "; Addnote(beat changed to :"<<curBeat.toFloat()<<endl;
+			ANTESCOFO_LOG(*this, "; Addnote(beat changed to :"<<curBeat.toFloat()<<endl);
 		} else {
 			// try to find nearest measure, and add beats...
 			rational diffb = 0;
-			for (map<rational, measure_elt>::const_iterator i = v_Notes.begin(); !abs_curBeat.toFloat() && i != v_Notes.end(); i++) {
-				for (int diffm = 1; diffm != 4; diffm++) {
-					if (i->second.nMeasure - diffm == nmeasure) {
-						diffb += i->second.duration;
-						for (int d = 0; d != diffm && i != v_Notes.end(); d++, i--) {
-							diffb += i->second.duration;
-						}
-						abs_curBeat = i->second.m_pos + diffb;
-						break;
-					}
+			int diffm = 0;
+			map<rational, measure_elt>::iterator i = v_Notes.end();
+			for (int d = 1; d != 4; d++) {
+				map<rational, measure_elt>::iterator next = findMeasure(nmeasure + d);
+				if ((next != v_Notes.end()) && ((i == v_Notes.end()) || (next->first < i->first))) {
+					i = next;
+					diffm = d;
+				}
+			}
+			if (i != v_Notes.end()) {
+				diffb += i->second.duration;
+				for (int d = 0; d != diffm; d++) {
+					diffb += i->second.duration;
+					if (i == v_Notes.begin()) break;
+					i--;
 				}
+				abs_curBeat = i->second.m_pos + diffb;
 			}
 			if (abs_curBeat.getNumerator()) {
 				curBeat = abs_curBeat;
-				cout << "; Addnote(beat interpolated changed to :"<<curBeat.toFloat()<<endl;
+				ANTESCOFO_LOG(*this, "; Addnote(beat interpolated changed to :"<<curBeat.toFloat()<<endl);
 			}
 			else {
-				cerr << "AntescofoWriter: something went wrong with note beats, check your MusicXML file, sorry." << endl;
-				print(false);
+				ANTESCOFO_LOG(*this, "AntescofoWriter: something went wrong with note beats, check your MusicXML file, sorry." << endl);
 				antescofo_abort();
+				return;
 			}
 		}
 	}
 #endif
-	if (curBeat.getNumerator() == 1. && nmeasure > 1)  { antescofo_abort(); }
-	if (flag_ == ANTESCOFO_FLAG_TIED_START) cout << "tie=Start";
-	if (flag_ == ANTESCOFO_FLAG_TIED_END) cout << "tie=End";
+	if (curBeat.getNumerator() == 1. && nmeasure > 1)  { antescofo_abort(); return; }
+	if (flag_ == ANTESCOFO_FLAG_TIED_START) ANTESCOFO_LOG(*this, "tie=Start");
+	if (flag_ == ANTESCOFO_FLAG_TIED_END) ANTESCOFO_LOG(*this, "tie=End");
 	// find note in vector
 	if (( i = findNoteInVector(curBeat, dur)) == v_Notes.end()) { // new note
-		measure_elt *e = new measure_elt();
-		e->nMeasure = nmeasure;
-		e->type = type;
+		measure_elt e;
+		e.nMeasure = nmeasure;
+		e.type = type;
 		dur.rationalise();
-		e->duration = dur;
-		e->m_pos = curBeat;
-		e->flags = flag_;
-		if (flag_ == ANTESCOFO_FLAG_FERMATA) e->bFermata = true;
-		if (fLastBPM != fBPM) { fLastBPM = fBPM; e->bpm = fBPM; }
+		e.duration = dur;
+		e.m_pos = curBeat;
+		e.flags = flag_;
+		if (flag_ == ANTESCOFO_FLAG_FERMATA) e.bFermata = true;
+		if (fLastBPM != fBPM) { fLastBPM = fBPM; e.bpm = fBPM; }
 		if (type == ANTESCOFO_NOTE || type == ANTESCOFO_CHORD || type == ANTESCOFO_REST) {
 			if (type != ANTESCOFO_REST) {
 				if (dur.toFloat() == .0) // grace
-					e->grace_pitches.push_back(pitch);
-				else e->pitches.push_back(pitch);
+					e.grace_pitches.push_back(pitch);
+				else e.pitches.push_back(pitch);
 			}   
-			cout << "; AddNote: adding single note: " << curBeat.toFloat() <<endl;
+			ANTESCOFO_LOG(*this, "; AddNote: adding single note: " << curBeat.toFloat() <<endl);
 		} else if (type == ANTESCOFO_TRILL) {
-			e->pitches.push_back(pitch);
-			cout << "; AddNote: TRILL note: " << curBeat.toFloat() <<endl;
+			e.pitches.push_back(pitch);
+			ANTESCOFO_LOG(*this, "; AddNote: TRILL note: " << curBeat.toFloat() <<endl);
 		} else if (type == ANTESCOFO_MULTI) {
-			e->pitches.push_back(pitch);
-			cout << "; AddNote: MULTI note: " << curBeat.toFloat() <<endl;
+			e.pitches.push_back(pitch);
+			ANTESCOFO_LOG(*this, "; AddNote: MULTI note: " << curBeat.toFloat() <<endl);
 		}
-		v_Notes[curBeat] = *e;
-		cout << endl;
+		v_Notes[curBeat] = e;
+		indexMeasure(nmeasure, curBeat);
+		touch(v_Notes.find(curBeat));
+		ANTESCOFO_LOG(*this, endl);
 	} else { // note already exists at this position
 		if (type == ANTESCOFO_REST) return;
 
 		if (i->second.m_pos != curBeat) { // if note was there, but not on the exact same beat
-			cout << "!!!!!!!!!!!! Inserting note in the middle of a previous one. !!!!!!!!!!!!!!" << endl;
-			cout << "<<<<<<<< WTF: " << i->second.m_pos.getNumerator() << "/" << i->second.m_pos.getDenominator() << " curBeat:" << curBeat.getNumerator() << "/" << curBeat.getDenominator() << " prevdur:"<< i->second.duration.toFloat() << " dur:" << dur.toFloat() << endl;
+			ANTESCOFO_LOG(*this, "!!!!!!!!!!!! Inserting note in the middle of a previous one. !!!!!!!!!!!!!!" << endl);
+			ANTESCOFO_LOG(*this, "<<<<<<<< WTF: " << i->second.m_pos.getNumerator() << "/" << i->second.m_pos.getDenominator() << " curBeat:" << curBeat.getNumerator() << "/" << curBeat.getDenominator() << " prevdur:"<< i->second.duration.toFloat() << " dur:" << dur.toFloat() << endl);
 			if (i->second.type == ANTESCOFO_REST) { // XXX only handle REST for now
 				rational d = i->second.duration;
-				cout << "!!!!!!!!!!!! Inserting note: previous note: beat:"<< i->second.m_pos.toFloat() << " dur:"<< i->second.duration.toFloat() << endl;
+				ANTESCOFO_LOG(*this, "!!!!!!!!!!!! Inserting note: previous note: beat:"<< i->second.m_pos.toFloat() << " dur:"<< i->second.duration.toFloat() << endl);
 				if (i->second.m_pos.getNumerator() == 0 && i->second.duration.getNumerator() == 0) return;
 				i->second.duration = curBeat - i->second.m_pos;//rational(curBeat*1000, 1000) - rational(i->second.m_pos * 1000, 1000);// shorten previous note duration
-				cout << "!!!!!!!!!!!! Inserting note: reducing first one dur:"<< i->second.duration.toFloat() << endl;
+				ANTESCOFO_LOG(*this, "!!!!!!!!!!!! Inserting note: reducing first one dur:"<< i->second.duration.toFloat() << endl);
 				if (i->second.duration + dur < d) { // if prev dur < dur add note
 					rational tmpcurbeat = curBeat + dur;//.toFloat();
 					rational bkpbeat = curBeat;
-					cout << "!!!!!!!!!!!!  Inserting note: dur:"<< (d - i->second.duration - dur).toFloat() << " atbeat:"<< tmpcurbeat.toFloat() << " !!!!!!!!!!!!!!" << endl;
+					ANTESCOFO_LOG(*this, "!!!!!!!!!!!!  Inserting note: dur:"<< (d - i->second.duration - dur).toFloat() << " atbeat:"<< tmpcurbeat.toFloat() << " !!!!!!!!!!!!!!" << endl);
 					if (((d - i->second.duration - dur).toFloat()) <= 0 ) return; 
 					AddNote(ANTESCOFO_REST, 0, d - i->second.duration - dur, nmeasure, tmpcurbeat);
 					curBeat = bkpbeat;
@@ -179,20 +255,22 @@ void antescofowriter::AddNote(int type, float pitch, rational dur, float nmeasur
 		if (i->second.duration == dur || dur.toFloat() == .0) { // if already present note's duration is same than new one, merge it
 			if (i->second.type == ANTESCOFO_REST) { // replace REST by NOTE
 				if (dur.toFloat() == .0) { // grace
-					cout << "Replace rest by grace note" << endl;
+					ANTESCOFO_LOG(*this, "Replace rest by grace note" << endl);
 					i->second.grace_pitches.push_back(pitch);
 					i->second.type = type;
 				} else {
-					cout << "Replace rest by note" << endl;
+					ANTESCOFO_LOG(*this, "Replace rest by note" << endl);
 					i->second.pitches.push_back(pitch);
 					i->second.type = type;
 					dur.rationalise();
 					i->second.duration = dur;
 				}
 				i->second.nMeasure = nmeasure;
+				indexMeasure(nmeasure, i->first);
 				i->second.m_pos = curBeat;
 				i->second.flags = flag_;
 				if (flag_ == ANTESCOFO_FLAG_FERMATA) i->second.bFermata = true;
+				touch(i);
 				return;
 			} else if (type != ANTESCOFO_REST && (i->second.type == ANTESCOFO_NOTE || i->second.type == ANTESCOFO_CHORD)) { // change NOTE to CHORD
 				if (i->second.duration.toFloat() == .0) // previous note was a grace note, so just add note.
@@ -206,10 +284,12 @@ void antescofowriter::AddNote(int type, float pitch, rational dur, float nmeasur
 					dur.rationalise();
 					i->second.duration = dur;
 					i->second.nMeasure = nmeasure;
+					indexMeasure(nmeasure, i->first);
 					i->second.m_pos = curBeat;
 					i->second.flags = flag_;
 					if (flag_ == ANTESCOFO_FLAG_FERMATA) i->second.bFermata = true;
-					cout << "; Addnote : handling grace note." << endl;
+					ANTESCOFO_LOG(*this, "; Addnote : handling grace note." << endl);
+					touch(i);
 					return;
 				}
 			}
@@ -219,6 +299,7 @@ void antescofowriter::AddNote(int type, float pitch, rational dur, float nmeasur
 				i->second.grace_pitches.push_back(pitch);
 			else i->second.pitches.push_back(pitch);
 			i->second.nMeasure = nmeasure;
+			indexMeasure(nmeasure, i->first);
 			i->second.m_pos = curBeat;
 		} else { // if already present note's duration is different of new one, create it.
 			/*
@@ -232,37 +313,40 @@ void antescofowriter::AddNote(int type, float pitch, rational dur, float nmeasur
 			int new_measure = nmeasure;
 			rational new_dur = i->second.duration - dur;
 			if (new_dur > rational(0)) { // note (or chord) already in the list is longer than new note: new note is shorter
-				cout << "; Addnote : expanding note: new_dur:" << new_dur.toFloat();
+				ANTESCOFO_LOG(*this, "; Addnote : expanding note: new_dur:" << new_dur.toFloat());
 				i->second.type = ANTESCOFO_CHORD;
 				i->second.pitches.push_back(pitch);
 				i->second.nMeasure = nmeasure;
+				indexMeasure(nmeasure, i->first);
 				i->second.m_pos = curBeat;
 
 				// on the beat: old + new
 				i->second.duration = dur;
-				cout << " shorten note: beat "<< i->second.m_pos.toFloat() << ", dur: "<< i->second.duration.toFloat() << " and new beat:"<< (curBeat+i->second.duration).toFloat()<<  ", dur:"<<new_dur.toFloat()<< endl;
+				touch(i);
+				ANTESCOFO_LOG(*this, " shorten note: beat "<< i->second.m_pos.toFloat() << ", dur: "<< i->second.duration.toFloat() << " and new beat:"<< (curBeat+i->second.duration).toFloat()<<  ", dur:"<<new_dur.toFloat()<< endl);
 
 				for (vector<int>::iterator c = i->second.pitches.begin(); c != i->second.pitches.end() && *c != pitch; c++) {
-					cout << "=============== ADDING NOTE: "<< *c << " b:"<< (new_beat - new_dur).toFloat()<< endl;
+					ANTESCOFO_LOG(*this, "=============== ADDING NOTE: "<< *c << " b:"<< (new_beat - new_dur).toFloat()<< endl);
 					rational tmpcurbeat = new_beat - new_dur;
 					new_dur.rationalise();
 					AddNote(ANTESCOFO_CHORD, -(*c), new_dur, new_measure, tmpcurbeat);
 				}
 			} else { // new note is longer than already present one, so copy present pitches into new note with new_dur duration
 				new_dur = rational(0) - new_dur;
-				cout << "; Addnote : expanding new longer note: new_dur:" << new_dur.toFloat() << endl;
+				ANTESCOFO_LOG(*this, "; Addnote : expanding new longer note: new_dur:" << new_dur.toFloat() << endl);
 
 				if (i->second.type == ANTESCOFO_REST) { // replace REST by NOTE, then add REST with diff duration
-					cout << "replace REST by NOTE, then add REST with diff duration"<<endl;
+					ANTESCOFO_LOG(*this, "replace REST by NOTE, then add REST with diff duration"<<endl);
 					i->second.pitches.push_back(pitch);
 					i->second.type = type;
 					i->second.duration = dur;
+					touch(i);
 					rational newbeat = curBeat + dur;
 					// check if next note(?s) needs to be shortened
 					map<rational, measure_elt>::iterator n = i;
 					n++;
 					if (n != v_Notes.end() && n->second.type == ANTESCOFO_REST) {
-						cout << "erasing " << newbeat.toFloat() << " SILENCE " << endl;
+						ANTESCOFO_LOG(*this, "erasing " << newbeat.toFloat() << " SILENCE " << endl);
 						v_Notes.erase(n->first);
 						new_dur.rationalise();
 						AddNote(ANTESCOFO_REST, 0, new_dur, nmeasure, newbeat);
@@ -281,27 +365,30 @@ void antescofowriter::AddNote(int type, float pitch, rational dur, float nmeasur
 					i->second.type = ANTESCOFO_CHORD;
 					i->second.pitches.push_back(pitch);
 					i->second.nMeasure = nmeasure;
+					indexMeasure(nmeasure, i->first);
 					i->second.m_pos = curBeat;
 
 					// on the beat+prevdur: only new
-					measure_elt *e = new measure_elt();
-					e->type = (v_Notes[curBeat].pitches.size() + 1 > 1 ? ANTESCOFO_CHORD : ANTESCOFO_NOTE);
+					measure_elt e;
+					e.type = (v_Notes[curBeat].pitches.size() + 1 > 1 ? ANTESCOFO_CHORD : ANTESCOFO_NOTE);
 					new_dur.rationalise();
-					e->duration = new_dur;
+					e.duration = new_dur;
 					rational tmpbeat = curBeat + i->second.duration; tmpbeat.rationalise();
 					for (vector<int>::iterator c = v_Notes[tmpbeat].pitches.begin(); c != v_Notes[tmpbeat].pitches.end(); c++)
-						e->pitches.push_back(-(*c));
-					e->pitches.push_back(-pitch);
-					e->nMeasure = nmeasure;
-					e->m_pos = tmpbeat;
-					e->flags = flag_;
-					if (flag_ == ANTESCOFO_FLAG_FERMATA) e->bFermata = true;
-					if (fLastBPM != fBPM) { fLastBPM = fBPM; e->bpm = fBPM; }
-					v_Notes[tmpbeat] = *e;// XXX que nenni si la note existe deja a cette position
+						e.pitches.push_back(-(*c));
+					e.pitches.push_back(-pitch);
+					e.nMeasure = nmeasure;
+					e.m_pos = tmpbeat;
+					e.flags = flag_;
+					if (flag_ == ANTESCOFO_FLAG_FERMATA) e.bFermata = true;
+					if (fLastBPM != fBPM) { fLastBPM = fBPM; e.bpm = fBPM; }
+					v_Notes[tmpbeat] = e;// XXX que nenni si la note existe deja a cette position
+					indexMeasure(nmeasure, tmpbeat);
+					touch(v_Notes.find(tmpbeat));
 				}
 			}
 		}
-
+		touch(i);
 	}
 	v_Notes[curBeat].rehearsal = rehearsal;
 }
@@ -311,12 +398,20 @@ void antescofowriter::print(bool with_header) {
 }
 
 
-void antescofowriter::write(const char *outfilename) {
-	ofstream outfile;
+void antescofowriter::write(ostream& out) {
+	writestream(out, true);
+}
+
+bool antescofowriter::write(const char *outfilename) {
+	if (fFailed) return false;
+	ostringstream buffer;
+	writestream(buffer, true);
+	const string& s = buffer.str();
 
-	outfile.open(outfilename);
-	writestream(outfile, true);
-	outfile.close();
+	ofstream outfile(outfilename);
+	if (!outfile.is_open()) return false;
+	outfile.write(s.data(), s.size());
+	return outfile.good();
 }
 
 
@@ -328,7 +423,7 @@ void antescofowriter::setSelectedParts(vector<string> parts)
 
 void antescofowriter::setSelectedStaves(vector<string> staves)
 {
-	for (vector<string>::iterator v = staves.begin(); v != staves.end(); v++) cout << "Not converting staff : "<<*v<< endl;
+	for (vector<string>::iterator v = staves.begin(); v != staves.end(); v++) ANTESCOFO_LOG(*this, "Not converting staff : "<<*v<< endl);
 	write_staves = staves;
 }
 
@@ -356,41 +451,47 @@ void antescofowriter::final_compress()
 	map<rational, measure_elt>::iterator next = v_Notes.begin();
 	map<rational, measure_elt>::iterator i = next;
 	next++;
-	for (; next != v_Notes.end(); next++) {
+	while (next != v_Notes.end()) {
+		bool merged = false;
 		if (next->second.nMeasure == i->second.nMeasure && next->second.type == i->second.type) {
 			if ((/*next->second.type == ANTESCOFO_NOTE ||*/ next->second.type == ANTESCOFO_REST)
 					&& next->second.pitches.size() && i->second.pitches.size() && next->second.pitches[0] == i->second.pitches[0]) {
-				merge_notes(i, next);
+				merged = merge_notes(i, next);
 			} else if ((next->second.type == ANTESCOFO_TRILL || next->second.type == ANTESCOFO_MULTI || next->second.type == ANTESCOFO_CHORD)
 					&& i->second.pitches == next->second.pitches) {
-				merge_notes(i, next);
+				merged = merge_notes(i, next);
 			}
 		}
-		i = next;
+		if (merged) next = i;	// next has been erased, i is compared to the following note
+		else i = next;
+		next++;
 	}
 
 	// - compress tied notes
 	if (v_Notes.size() < 2) return;
 	i = next = v_Notes.begin();
 	next++;
-	for (; next != v_Notes.end(); next++) {
+	while (next != v_Notes.end()) {
+		bool merged = false;
 		if (next->second.type == i->second.type && next->second.pitches == i->second.pitches
 				&& i->second.flags == ANTESCOFO_FLAG_TIED_START && next->second.flags == ANTESCOFO_FLAG_TIED_END) {
-			cout << "Got tied notes (pos:"<<i->first.toFloat()<<")... merging note." <<endl;
-			merge_notes(i, next);
+			ANTESCOFO_LOG(*this, "Got tied notes (pos:"<<i->first.toFloat()<<")... merging note." <<endl);
+			merged = merge_notes(i, next);
 		}
-		i = next;
+		if (merged) next = i;
+		else i = next;
+		next++;
 	}
 
 }
 
 
 // merge 2 notes a and b (add durations) in a, and delete b
-void antescofowriter::merge_notes(map<rational, measure_elt>::iterator a, map<rational, measure_elt>::iterator b) {
-	cout << "merge_notes " << a->first.toFloat() << " and " << b->first.toFloat() << endl;
+bool antescofowriter::merge_notes(map<rational, measure_elt>::iterator a, map<rational, measure_elt>::iterator b) {
+	ANTESCOFO_LOG(*this, "merge_notes " << a->first.toFloat() << " and " << b->first.toFloat() << endl);
 	if (a->second.bpm.size()) {
 		if (b->second.bpm.size())
-			return; // do nothing if two note are separated by different tempos
+			return false; // do nothing if two note are separated by different tempos
 	} else if (b->second.bpm.size())
 		a->second.bpm = b->second.bpm;
 	if (a->second.nMeasure != b->second.nMeasure) { //tied note between different measures
@@ -399,14 +500,16 @@ void antescofowriter::merge_notes(map<rational, measure_elt>::iterator a, map<ra
 	}
 	a->second.duration += b->second.duration;
 	v_Notes.erase(b);
+	touch(a);
+	return true;
 }
 
 
 
 void antescofowriter::antescofo_abort() {
-	cout << "Antescofo abort: -------------- An error occured, leaving. ----------------" << endl;
-	print(false);
-	abort();
+	ANTESCOFO_LOG(*this, "Antescofo abort: -------------- An error occured, leaving. ----------------" << endl);
+	if (fLog) writestream(*fLog, false);
+	fFailed = true;
 }
 
 void antescofowriter::print_duration(ostream &out, rational &du) {
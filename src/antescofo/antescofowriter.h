@@ -33,6 +33,9 @@ using namespace std;
 namespace MusicXML2
 {
 
+// writes diagnostics to the logger of an antescofowriter, when there is one
+#define ANTESCOFO_LOG(w, msg)	do { if ((w).log()) *(w).log() << msg; } while (0)
+
 // measure_elt_types
 #   define ANTESCOFO_REST           0
 #   define ANTESCOFO_CHORD          1
@@ -76,7 +79,7 @@ class antescofowriter {
 	public:
 		enum pedalType { kDamperPedal, kSoftpedal, kSostenutoPedal };
 
-		antescofowriter() : nBeats(4), fBPM("120"), fLastBPM("0"), print_notes_names(true) { }
+		antescofowriter() : nBeats(4), fBPM("120"), fLastBPM("0"), print_notes_names(true), fLog(0), fLeaves(0), fFailed(false) { }
 		~antescofowriter() {}
 
 		map<rational, measure_elt> v_Notes;
@@ -90,6 +93,13 @@ class antescofowriter {
 		bool print_notes_names;
 		void setBPM(string _bpm) { fBPM = _bpm; }
 
+		// diagnostics are written to an optional logger (none by default)
+		void setLog(ostream* log)	{ fLog = log; }
+		ostream* log() const		{ return fLog; }
+		// true when the conversion failed: the following notes are ignored
+		bool failed() const			{ return fFailed; }
+
+		// gives the note at atbeat or the first note containing atbeat
 		map<rational, measure_elt>::iterator findNoteInVector(rational atbeat, rational dur);
 
 		// search for beat&measure in measure2beat map, 
@@ -105,7 +115,10 @@ class antescofowriter {
 		void AddNote(int type, float pitch, rational dur, float nmeasure, rational &curBeat, int flag_ = ANTESCOFO_FLAG_NULL, string rehearsal = "");
 
 		void print(bool with_header=true);
-		void write(const char *outfilename);
+		// writes the score with its header
+		void write(ostream& out);
+		// writes the score to a file, using a single write
+		bool write(const char *outfilename);
 
 		void setSelectedParts(vector<string> parts);
 		void setSelectedStaves(vector<string> staves);
@@ -114,6 +127,23 @@ class antescofowriter {
 
 
 	protected:
+		ostream* fLog;
+		map<int, rational> measure2pos;	// the first note position of each measure
+		vector<rational> fEnds;			// the max end of the notes starting in each beat, as a segment tree:
+		long fLeaves;					// notes containing a position are looked for in the beats where notes end after
+		bool fFailed;					// set by antescofo_abort
+
+		// updates fEnds with a new or modified note
+		void touch(map<rational, measure_elt>::const_iterator i);
+		// gives the first beat in [from, to] where notes end after atbeat, -1 when none
+		long firstEnd(long node, long low, long high, long from, long to, const rational& atbeat) const;
+		// gives the beat index of a position
+		static long beatIndex(const rational& pos);
+
+		// keeps track of the first note position of each measure
+		void indexMeasure(int nmeasure, const rational& pos);
+		// gives the first note of a measure
+		map<rational, measure_elt>::iterator findMeasure(int nmeasure);
 
 		// final processing :
 		// - compress for each note, if the following note is the same pitch, and if they belong to the same measure
@@ -122,8 +152,10 @@ class antescofowriter {
 		void final_compress();
 
 		// merge 2 notes a and b (add durations) in a, and delete b
-		void merge_notes(map<rational, measure_elt>::iterator a, map<rational, measure_elt>::iterator b);
+		// returns false when the notes are not merged
+		bool merge_notes(map<rational, measure_elt>::iterator a, map<rational, measure_elt>::iterator b);
 
+		// marks the conversion as failed (see failed())
 		void antescofo_abort();
 		void print_duration(ostream &out, rational &du);
 		void writenote(ostream &out, int pitch);
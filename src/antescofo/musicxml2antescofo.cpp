@@ -15,6 +15,8 @@
 #endif
 
 #include <iostream>
+#include <sstream>
+#include "doccache.h"
 #include "libmusicxml.h"
 #include "xml.h"
 #include "xmlfile.h"
@@ -31,7 +33,8 @@ namespace MusicXML2
 	
 
 //_______________________________________________________________________________
-static xmlErr xml2antescofo(SXMLFile& xmlfile, bool generateBars, ostream& out, const char* file) 
+// the conversion is made in memory, the output is sent with a single write
+static xmlErr xml2antescofo(SXMLFile& xmlfile, bool generateBars, string& out, const char* file) 
 {
 	Sxmlelement st = xmlfile->elements();
 	if (st) {
@@ -39,23 +42,43 @@ static xmlErr xml2antescofo(SXMLFile& xmlfile, bool generateBars, ostream& out,
 
 		xml2antescofovisitor v(w, true, true, generateBars);
 		Santescofoelement as = v.convert(st);
+		if (w.failed()) return kInvalidFile;
+		ostringstream buffer;
 		if (file) {
-			out << "; Antescofo partition converted from '" << file << "'" << endl
+			buffer << "; Antescofo partition converted from '" << file << "'" << endl
 				<< ";  using libmusicxml v." << musicxmllibVersionStr() << endl;
 		}
-		else out << ";  Antescofo code converted using libmusicxml v." << musicxmllibVersionStr() << endl;
-		out << "; and the embedded xml2antescofo converter v." << musicxml2antescofoVersionStr() << endl;
-		//out << as << endl;
+		else buffer << ";  Antescofo code converted using libmusicxml v." << musicxmllibVersionStr() << endl;
+		buffer << "; and the embedded xml2antescofo converter v." << musicxml2antescofoVersionStr() << endl;
+		//buffer << as << endl;
 
-		w.print();
+		w.write(buffer);
+		out = buffer.str();
 		return kNoErr;
 	}
 	return kInvalidFile;
 }
 
+static xmlErr write(xmlErr err, const string& buffer, ostream& out) 
+{
+	if (err == kNoErr)
+		out.write (buffer.data(), buffer.size());
+	return err;
+}
+
+static xmlErr xml2antescofo(SXMLFile& xmlfile, bool generateBars, ostream& out, const char* file) 
+{
+	string buffer;
+	return write (xml2antescofo(xmlfile, generateBars, buffer, file), buffer, out);
+}
+
 //_______________________________________________________________________________
 EXP xmlErr musicxmlfile2antescofo(const char *file, bool generateBars, ostream& out) 
 {
+	if (doccache::enabled()) {
+		string buffer;
+		return write (doccache::convertfile (file, "antescofo", xml2antescofo, generateBars, buffer), buffer, out);
+	}
 	xmlreader r;
 	SXMLFile xmlfile;
 	xmlfile = r.read(file);
@@ -80,6 +103,24 @@ EXP xmlErr musicxmlfd2antescofo(FILE * fd, bool generateBars, ostream& out)
 //_______________________________________________________________________________
 EXP xmlErr musicxmlstring2antescofo(const char * buffer, bool generateBars, ostream& out) 
 {
+	if (doccache::enabled()) {
+		string code;
+		return write (doccache::convertbuff (buffer, "antescofo", xml2antescofo, generateBars, code), code, out);
+	}
+	xmlreader r;
+	SXMLFile xmlfile;
+	xmlfile = r.readbuff(buffer);
+	if (xmlfile) {
+		return xml2antescofo(xmlfile, generateBars, out, 0);
+	}
+	return kInvalidFile;
+}
+
+//_______________________________________________________________________________
+EXP xmlErr musicxmlstring2antescofostring(const char * buffer, bool generateBars, string& out) 
+{
+	if (doccache::enabled())
+		return doccache::convertbuff (buffer, "antescofo", xml2antescofo, generateBars, out);
 	xmlreader r;
 	SXMLFile xmlfile;
 	xmlfile = r.readbuff(buffer);
@@ -54,7 +54,7 @@ Santescofoelement xml2antescofovisitor::convert (const Sxmlelement& xml)
 // it must be written only once, at the beginning of the first antescofo voice
 // thus the function clears the data when flushed so that further calls do nothing
 //______________________________________________________________________________
-void xml2antescofovisitor::flushHeader ( scoreHeader& header )
+void xml2antescofovisitor::flushHeader ( antescofoScoreHeader& header )
 {
 	if (header.fTitle) {
 		Santescofoelement tag = antescofotag::create("title");
@@ -86,7 +86,7 @@ void xml2antescofovisitor::flushHeader ( scoreHeader& header )
 // it must be written only once, at the beginning of the corresponding antescofo voice
 // thus the function clears the data when flushed so that further calls do nothing
 //______________________________________________________________________________
-void xml2antescofovisitor::flushPartHeader ( partHeader& header )
+void xml2antescofovisitor::flushPartHeader ( antescofoPartHeader& header )
 {
 	if (header.fPartName && header.fPartName->getValue().size()) {
 		Santescofoelement tag = antescofotag::create("instr");
@@ -36,12 +36,12 @@ namespace MusicXML2
 typedef struct {
 	S_movement_title		fTitle;
 	std::vector<S_creator>	fCreators;
-} scoreHeader;
+} antescofoScoreHeader;
 
 typedef struct {
 	S_part_name		fPartName;
-} partHeader;
-typedef std::map<std::string, partHeader> partHeaderMap;
+} antescofoPartHeader;
+typedef std::map<std::string, antescofoPartHeader> antescofoPartHeaderMap;
 
 
 /*!
@@ -60,8 +60,8 @@ class EXP xml2antescofovisitor :
 	std::stack<Santescofoelement>	fStack;
 	bool	fGenerateComments, fGenerateStem, fGenerateBars, fGeneratePositions;
 
-	scoreHeader	fHeader;	// musicxml header elements (should be flushed at the beginning of the first voice)
-	partHeaderMap	fPartHeaders;	// musicxml score-part elements (should be flushed at the beginning of each part)
+	antescofoScoreHeader	fHeader;	// musicxml header elements (should be flushed at the beginning of the first voice)
+	antescofoPartHeaderMap	fPartHeaders;	// musicxml score-part elements (should be flushed at the beginning of each part)
 	std::string	fCurrentPartID;
 	int		fCurrentStaffIndex;		// the index of the current antescofo staff
 
@@ -71,8 +71,8 @@ class EXP xml2antescofovisitor :
 	void pop ()							{ fStack.pop(); }
 
 
-	void flushHeader ( scoreHeader& header );
-	void flushPartHeader ( partHeader& header );
+	void flushHeader ( antescofoScoreHeader& header );
+	void flushPartHeader ( antescofoPartHeader& header );
 
 	protected:
 
@@ -154,13 +154,13 @@ void xmlpart2antescofo::checkVoiceTime ( const rational& currTime, const rationa
 	rational diff = currTime - voiceTime;
 	diff.rationalise();
 	if (diff.getNumerator() > 0) {
-		cout << "checkVoiceTime: adding rest note dur:"<<diff.getNumerator() << "/"<<diff.getDenominator() << endl;
+		ANTESCOFO_LOG(w, "checkVoiceTime: adding rest note dur:"<<diff.getNumerator() << "/"<<diff.getDenominator() << endl);
 		w.AddNote(ANTESCOFO_REST, 0, diff, fMeasNum, fCurBeat, 0);
 		fCurrentVoicePosition += diff;
 		fCurrentVoicePosition.rationalise();
 	}
 	else if (diff.getNumerator() < 0)
-		cerr << "warning! checkVoiceTime: measure time behind voice time " << string(diff) << endl;
+		ANTESCOFO_LOG(w, "warning! checkVoiceTime: measure time behind voice time " << string(diff) << endl);
 }
 
 //______________________________________________________________________________
@@ -169,7 +169,7 @@ void xmlpart2antescofo::visitStart ( S_backup& elt )
 	fInBackup = true;
 	stackClean();	// closes pending chords, cue and grace
 	int duration = elt->getIntValue(k_duration, 0);
-	cout << "BACKUP ----------------< " << duration <<  " fCurBeat:" << fCurBeat.toFloat() << endl;
+	ANTESCOFO_LOG(w, "BACKUP ----------------< " << duration <<  " fCurBeat:" << fCurBeat.toFloat() << endl);
 
 	if (duration) {
 		// backup is supposed to be used only for moving between voices
@@ -180,9 +180,9 @@ void xmlpart2antescofo::visitStart ( S_backup& elt )
 		if (scanElement) 
 		{
 			//fCurBeat -= rational(duration, fCurrentDivision);
-			cout << "BACKUP -----> going back of "<<noteDuration(*this).toFloat() << endl;
+			ANTESCOFO_LOG(w, "BACKUP -----> going back of "<<noteDuration(*this).toFloat() << endl);
 			fCurBeat -= noteDuration(*this); 
-			cout << "BACKUP ---------------- fCurBeat:" << fCurBeat.toFloat() << endl;
+			ANTESCOFO_LOG(w, "BACKUP ---------------- fCurBeat:" << fCurBeat.toFloat() << endl);
 			if (fCurBeat.toFloat() <= 0)
 				fCurBeat = rational(1);
 		}
@@ -196,7 +196,7 @@ void xmlpart2antescofo::visitStart ( S_forward& elt )
 	bool scanElement = (elt->getIntValue(k_voice, 0) == fTargetVoice)
 		&& (elt->getIntValue(k_staff, 0) == fTargetStaff);
 	int duration = elt->getIntValue(k_duration, 0);
-	cout << "FORWARD("<<scanElement<<") ----------------> " << rational(duration, fCurrentDivision).toFloat() << endl;
+	ANTESCOFO_LOG(w, "FORWARD("<<scanElement<<") ----------------> " << rational(duration, fCurrentDivision).toFloat() << endl);
 
 	if (fCurBeat.toFloat() == 1 && fMeasNum > 1)
 		moveMeasureTime(rational(duration), true);
@@ -208,7 +208,7 @@ void xmlpart2antescofo::visitStart ( S_forward& elt )
 	if (duration) {		
 		rational r = noteDuration(*this);
 		r.rationalise();
-		cout << "forward: adding rest, maybe wrong?" << endl;
+		ANTESCOFO_LOG(w, "forward: adding rest, maybe wrong?" << endl);
 		w.AddNote(ANTESCOFO_REST, 0, r, fMeasNum, fCurBeat, 0);
 		fMeasureEmpty = false;
 	}
@@ -223,7 +223,7 @@ void xmlpart2antescofo::visitStart ( S_forward& elt )
 void xmlpart2antescofo::visitStart ( S_part& elt ) 
 {
 	if (!current()) {
-    cout << endl << "--------------------------------- visit start S_part " << endl;
+    ANTESCOFO_LOG(w, endl << "--------------------------------- visit start S_part " << endl);
 		reset();
 		Santescofoelement seq = antescofoseq::create();
 		start (seq);
@@ -267,16 +267,16 @@ void xmlpart2antescofo::visitStart ( S_measure& elt )
 	fPendingPops = 0;
 	fMeasureEmpty = true;
 
-	cout << "--------------------------------- visit start S_measure: fMeasNum:"<<fMeasNum << " fCurBeat:"<< fCurBeat.toFloat() << endl;
+	ANTESCOFO_LOG(w, "--------------------------------- visit start S_measure: fMeasNum:"<<fMeasNum << " fCurBeat:"<< fCurBeat.toFloat() << endl);
 }
         
 
 //______________________________________________________________________________
 void xmlpart2antescofo::visitEnd ( S_measure& elt ) 
 {
-	cout << "--------------------------------- visit end S_measure: fCurBeat:"<<fCurBeat.toFloat() << endl;
+	ANTESCOFO_LOG(w, "--------------------------------- visit end S_measure: fCurBeat:"<<fCurBeat.toFloat() << endl);
 
-	cout << "fCurrentMeasureLength: "<<fCurrentMeasureLength.toFloat() << " fCurBeat:"<< fCurBeat.toFloat() << " "<< endl;// << " d:"  << fCurrentMeasureLength.toFloat() - fCurBeat << endl;
+	ANTESCOFO_LOG(w, "fCurrentMeasureLength: "<<fCurrentMeasureLength.toFloat() << " fCurBeat:"<< fCurBeat.toFloat() << " "<< endl);// << " d:"  << fCurrentMeasureLength.toFloat() - fCurBeat << endl;
 	checkVoiceTime (fCurrentMeasureLength, fCurrentVoicePosition);
 
 	if (!fInhibitNextBar) {
@@ -291,7 +291,7 @@ void xmlpart2antescofo::visitEnd ( S_measure& elt )
 	if (!scanElement) {
 		rational d(fCurrentMeasureLength.toFloat(), fCurrentDivision); d.rationalise();
 		//rational d = noteDuration(*this);
-		cout << "visitEnd S_measure: add fCurBeat:" << fCurBeat.toFloat() << " : " << d.toFloat() << endl;
+		ANTESCOFO_LOG(w, "visitEnd S_measure: add fCurBeat:" << fCurBeat.toFloat() << " : " << d.toFloat() << endl);
 		fCurBeat += d;
 		fLastDur = d;
 	}
@@ -301,7 +301,7 @@ void xmlpart2antescofo::visitEnd ( S_measure& elt )
 //______________________________________________________________________________
 void xmlpart2antescofo::visitStart ( S_rehearsal& elt ) 
 {
-	cout << "rehearsal:"<< elt->getValue() << endl;
+	ANTESCOFO_LOG(w, "rehearsal:"<< elt->getValue() << endl);
 	fRehearsals = elt->getValue();
 }
 
@@ -378,7 +378,7 @@ void xmlpart2antescofo::visitEnd ( S_metronome& elt )
 	string str;
 	s >> str;
 	w.setBPM(str);
-	cout << "xmlpart2antescofo : got metronome : BPM: "<< metronomevisitor::fPerMinute<< endl;
+	ANTESCOFO_LOG(w, "xmlpart2antescofo : got metronome : BPM: "<< metronomevisitor::fPerMinute<< endl);
 }
 
 //______________________________________________________________________________
@@ -454,7 +454,7 @@ void xmlpart2antescofo::visitEnd ( S_sound& elt )
 		}
 		else if ((attribute = elt->getAttribute("fine"))) {
 		} else if ((attribute = elt->getAttribute("tempo"))) {
-            cout << "xmlpart2antescofo : got sound tempo : BPM: "<< attribute->getValue() << endl;
+            ANTESCOFO_LOG(w, "xmlpart2antescofo : got sound tempo : BPM: "<< attribute->getValue() << endl);
             w.setBPM(attribute->getValue());
         }
 	}*/
@@ -480,7 +480,7 @@ void xmlpart2antescofo::visitEnd ( S_repeat& elt )
 	else if (direction == "backward") {
 		fRepeatBackward = true;
 	}
-	cout << "visitEnd: direction: repeat: "<< direction << endl;
+	ANTESCOFO_LOG(w, "visitEnd: direction: repeat: "<< direction << endl);
 }
 
 //______________________________________________________________________________
@@ -546,7 +546,7 @@ void xmlpart2antescofo::visitEnd ( S_clef& elt )
 	else if ( clefvisitor::fSign == "TAB")	s << "TAB";
 	else if ( clefvisitor::fSign == "none")	s << "none";
 	else {													// unknown clef sign !!
-		cerr << "warning: unknown clef sign \"" << clefvisitor::fSign << "\"" << endl;
+		ANTESCOFO_LOG(w, "warning: unknown clef sign \"" << clefvisitor::fSign << "\"" << endl);
 		return;	
 	}
 
@@ -599,7 +599,7 @@ bool xmlpart2antescofo::checkTiedBegin ( const std::vector<S_tied>& tied )
 	std::vector<S_tied>::const_iterator i = findTypeValue(tied, "start");
 	bool r = false;
 	if (i != tied.end()) {
-		cout << "got start Tied"<<endl;
+		ANTESCOFO_LOG(w, "got start Tied"<<endl);
 		r = true;
 	}
 	return r;
@@ -611,7 +611,7 @@ bool xmlpart2antescofo::checkTiedEnd ( const std::vector<S_tied>& tied )
 	bool r = false;
 
 	if (i != tied.end()) {
-		cout << "got end Tied"<<endl;
+		ANTESCOFO_LOG(w, "got end Tied"<<endl);
 		r = true;
 	}
 	return r;
@@ -799,7 +799,7 @@ string xmlpart2antescofo::noteName ( const notevisitor& nv )
 	else {
 		name = nv.getStep();
 		if (!name.empty()) name[0]=tolower(name[0]);
-		else cerr << "warning: empty note name" << endl;
+		else ANTESCOFO_LOG(w, "warning: empty note name" << endl);
 	}
 
 	//cout << "================== getalter name:: " << name << endl;;
@@ -885,14 +885,14 @@ void xmlpart2antescofo::visitStart ( S_duration& elt )
 		rational r(duration, fCurrentDivision);
 		r.rationalise();
 		if (fInBackup) {
-			cout << "Backup duration : removing "<< r.toFloat()<<" to fCurBeat:"<<fCurBeat.toFloat() << endl;
+			ANTESCOFO_LOG(w, "Backup duration : removing "<< r.toFloat()<<" to fCurBeat:"<<fCurBeat.toFloat() << endl);
 			fCurBeat -= r;
-			cout << "Backup duration : new fCurBeat:"<<fCurBeat.toFloat() << endl;
+			ANTESCOFO_LOG(w, "Backup duration : new fCurBeat:"<<fCurBeat.toFloat() << endl);
 		}
 		else if (fInForward) {
-			cout << "Forward duration : adding "<< r.toFloat()<<" to fCurBeat:"<< fCurBeat.toFloat() << endl;
+			ANTESCOFO_LOG(w, "Forward duration : adding "<< r.toFloat()<<" to fCurBeat:"<< fCurBeat.toFloat() << endl);
 			fCurBeat += r;
-			cout << "Forward duration : new fCurBeat:"<<fCurBeat.toFloat() << endl;
+			ANTESCOFO_LOG(w, "Forward duration : new fCurBeat:"<<fCurBeat.toFloat() << endl);
 		}
 	}
 	if (fCurBeat.toFloat() <= 0) fCurBeat = rational(1);
@@ -935,7 +935,7 @@ void xmlpart2antescofo::newNote ( const notevisitor& nv,  S_note& elt  )
 		ss << fCurrentStaff;
 		if (*v == ss.str()) {
 			badstaff = false;
-			cout << " ------------------------------------------ WARNING not converting this staff: " << *v << endl;
+			ANTESCOFO_LOG(w, " ------------------------------------------ WARNING not converting this staff: " << *v << endl);
 		}
 	}
 	if (badstaff) {
@@ -945,7 +945,7 @@ void xmlpart2antescofo::newNote ( const notevisitor& nv,  S_note& elt  )
 	assert(fCurBeat.toFloat() > 0);
 	fCurBeat.rationalise();
 	if (nv.inChord() && !fTrill && !fGlissandoStart && !fGlissandoStop) {
-		cout << "newNote: isInChord so removing "<< fLastDur.toFloat() << " to curBeat: " << fCurBeat.toFloat() << endl;
+		ANTESCOFO_LOG(w, "newNote: isInChord so removing "<< fLastDur.toFloat() << " to curBeat: " << fCurBeat.toFloat() << endl);
 		fCurBeat -= fLastDur; // because fucking MusicXML notation <chord/> is full of shit
 		fLastDur = 0;
 		w.AddNote(ANTESCOFO_CHORD, getMidiPitch(nv), d, fMeasNum, fCurBeat, flag, fRehearsals);
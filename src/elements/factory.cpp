@@ -23,6 +23,7 @@
 #include <iostream>
 #include "elements.h"
 #include "factory.h"
+#include "profiler.h"
 #include "types.h"
 
 using namespace std; 
@@ -45,6 +46,7 @@ Sxmlelement factory::create(const string& eltname) const
 		functor<Sxmlelement>* f= i->second;
 		if (f) {
 			Sxmlelement elt = (*f)();
+			PROFILE_COUNT(kNodesCreated, 1);
 			elt->setName(eltname);
 			return elt;
 		}
@@ -0,0 +1,214 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <string>
+#include <utility>
+
+#include "clonevisitor.h"
+#include "factory.h"
+#include "unrolled_view.h"
+#include "unrolled_xml_tree_browser.h"
+#include "xml_tree_browser.h"
+#include "xmlvisitor.h"
+
+using namespace std;
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// collects the sequence of the played measures of each part
+//______________________________________________________________________________
+class measurescollector :
+	public visitor<S_part>,
+	public visitor<S_measure>
+{
+	public:
+		typedef pair<Sxmlelement, vector<Sxmlelement> > partmeasures;
+		vector<partmeasures> fParts;
+
+		virtual void visitStart( S_part& elt )		{ fParts.push_back (make_pair(elt, vector<Sxmlelement>())); }
+		virtual void visitStart( S_measure& elt )	{ if (fParts.size()) fParts.back().second.push_back(elt); }
+};
+
+//______________________________________________________________________________
+// the measures content is not required to collect the measures
+class measuresbrowser : public unrolled_xml_tree_browser
+{
+	public:
+				 measuresbrowser(basevisitor* v) : unrolled_xml_tree_browser(v) {}
+		virtual ~measuresbrowser() {}
+		virtual void forwardBrowse (xmlelement& t)	{ enter(t); leave(t); }
+};
+
+//______________________________________________________________________________
+// unrolled_view
+//______________________________________________________________________________
+Sunrolled_view unrolled_view::create (const Sxmlelement& score)
+	{ unrolled_view* o = new unrolled_view(score); assert(o!=0); return o; }
+
+// the view elements are built using elements().push_back() and not push():
+// the source elements are shared and are not attached to the view elements
+unrolled_view::unrolled_view(const Sxmlelement& score)
+{
+	measurescollector collector;
+	measuresbrowser browser(&collector);
+	browser.browse(*score);
+
+	fScore = shallowcopy (score);
+	vector<measurescollector::partmeasures>::const_iterator p = collector.fParts.begin();
+	for (ctree<xmlelement>::literator i = score->lbegin(); i != score->lend(); i++) {
+		if ((p != collector.fParts.end()) && (p->first == *i)) {
+			fScore->elements().push_back (part (p->first, p->second));
+			p++;
+		}
+		else fScore->elements().push_back (*i);		// part-list and header elements are shared
+	}
+}
+
+//______________________________________________________________________________
+Sxmlelement unrolled_view::shallowcopy (const Sxmlelement& elt, bool withattributes) const
+{
+	Sxmlelement copy = factory::instance().create(elt->getType());
+	if (copy) {
+		copy->setName (elt->getName());
+		copy->setValue (elt->getValue());
+		if (withattributes) {
+			vector<Sxmlattribute>::const_iterator attr;
+			for (attr = elt->attributes().begin(); attr != elt->attributes().end(); attr++)
+				copy->add (*attr);
+		}
+	}
+	return copy;
+}
+
+//______________________________________________________________________________
+Sxmlelement unrolled_view::part (const Sxmlelement& elt, const vector<Sxmlelement>& measures)
+{
+	fCurrentKey = fCurrentClef = fCurrentTime = Sxmlelement();
+	Sxmlelement view = shallowcopy (elt);
+	long number = 1;
+	for (vector<Sxmlelement>::const_iterator i = measures.begin(); i != measures.end(); i++)
+		view->elements().push_back (measure (*i, number++));
+	fParts.push_back (view);
+	fSources.push_back (measures);
+	return view;
+}
+
+//______________________________________________________________________________
+Sxmlelement unrolled_view::measure (const Sxmlelement& elt, long number)
+{
+	Sxmlelement view = shallowcopy (elt, false);
+	vector<Sxmlattribute>::const_iterator attr;
+	for (attr = elt->attributes().begin(); attr != elt->attributes().end(); attr++) {
+		if ((*attr)->getName() == "number") {
+			Sxmlattribute num = xmlattribute::create();
+			num->setName ("number");
+			num->setValue (number);
+			view->add (num);
+		}
+		else view->add (*attr);
+	}
+	for (ctree<xmlelement>::literator i = elt->lbegin(); i != elt->lend(); i++) {
+		Sxmlelement child = unroll (*i);
+		if (child) view->elements().push_back (child);
+	}
+	return view;
+}
+
+//______________________________________________________________________________
+static Sxmlelement changeState (Sxmlelement& current, const Sxmlelement& elt)
+{
+	if (elt == current) return 0;		// redundant with the current state: dropped
+	current = elt;
+	return elt;
+}
+
+static bool isJump (const string& name)
+{
+	return	(name == "segno") || (name == "forward-repeat") || (name == "coda") || (name == "fine") ||
+			(name == "dacapo") || (name == "dalsegno") || (name == "tocoda");
+}
+
+//______________________________________________________________________________
+// returns the element itself when unchanged, a synthetic element when it has
+// to be modified and a null element when it has to be removed
+Sxmlelement unrolled_view::unroll (const Sxmlelement& elt)
+{
+	switch (elt->getType()) {
+		case k_ending:
+		case k_repeat:
+			return 0;
+
+		case k_key:		return changeState (fCurrentKey, elt);
+		case k_clef:	return changeState (fCurrentClef, elt);
+		case k_time:	return changeState (fCurrentTime, elt);
+
+		case k_sound: {
+			vector<Sxmlattribute>::const_iterator attr;
+			for (attr = elt->attributes().begin(); attr != elt->attributes().end(); attr++)
+				if (isJump ((*attr)->getName())) break;
+			if (attr == elt->attributes().end()) return elt;
+
+			Sxmlelement view = shallowcopy (elt, false);
+			for (attr = elt->attributes().begin(); attr != elt->attributes().end(); attr++)
+				if (!isJump ((*attr)->getName())) view->add (*attr);
+			view->elements() = elt->elements();
+			return view;
+		}
+
+		// containers that may include elements to be modified
+		case k_attributes:
+		case k_barline:
+		case k_direction: {
+			Sxmlelement view;
+			for (int i = 0; i < elt->size(); i++) {
+				const Sxmlelement& child = elt->elements()[i];
+				Sxmlelement unrolled = unroll (child);
+				if (!view && (unrolled != child)) {		// first modified child: switch to a synthetic element
+					view = shallowcopy (elt);
+					view->elements().assign (elt->elements().begin(), elt->elements().begin() + i);
+				}
+				if (view && unrolled) view->elements().push_back (unrolled);
+			}
+			return view ? view : elt;
+		}
+	}
+	return elt;
+}
+
+//______________________________________________________________________________
+void unrolled_view::browse (basevisitor& v) const
+{
+	xml_tree_browser browser(&v);
+	browser.browse (*fScore);
+}
+
+//______________________________________________________________________________
+Sxmlelement unrolled_view::materialize () const
+{
+	clonevisitor cv;
+	browse (cv);
+	return cv.clone();
+}
+
+//______________________________________________________________________________
+void unrolled_view::print (ostream& out) const
+{
+	xmlvisitor v(out);
+	browse (v);
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __unrolled_view__
+#define __unrolled_view__
+
+#include <ostream>
+#include <vector>
+#include "basevisitor.h"
+#include "smartpointer.h"
+#include "typedefs.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup MusicXML
+@{
+*/
+
+class unrolled_view;
+typedef SMARTP<unrolled_view> Sunrolled_view;
+
+//______________________________________________________________________________
+/*!
+\brief An "unrolled" view of a score that doesn't copy the score.
+
+  The view presents the score as played by the unrolled_xml_tree_browser, i.e. with
+  the repeated sections, da capo, dal segno and coda jumps expanded. Contrary to
+  the unrolled_clonevisitor, the measures are not cloned: each unrolled measure is a
+  light element that refers to the children of the original measure. Only the elements
+  that differ from the original are synthesized:
+	- the measure itself, renumbered according to the unrolled sequence,
+	- the \b key, \b clef and \b time elements are dropped when they repeat the current state,
+	- the \b ending and \b repeat elements are dropped,
+	- the \b sound elements loose their jump attributes (segno, coda, dacapo...),
+	- and the containers of the above elements.
+
+  The view can be browsed like any other tree using the score() element. Note that
+  the view shares its elements with the original score: modifying an element of
+  the view modifies the original score as well. Use materialize() to get an
+  independent copy of the unrolled score.
+*/
+class EXP unrolled_view : public smartable
+{
+	public:
+		static Sunrolled_view create (const Sxmlelement& score);
+
+		//! the root element of the view
+		Sxmlelement			score() const					{ return fScore; }
+		//! the parts count
+		int					parts() const					{ return int(fParts.size()); }
+		//! the view of a part
+		Sxmlelement			part (int index) const			{ return fParts[index]; }
+		//! the unrolled measures count of a part
+		int					measures (int part) const		{ return int(fParts[part]->size()); }
+		//! the view of an unrolled measure
+		Sxmlelement			measure (int part, int index) const	{ return fParts[part]->elements()[index]; }
+		//! the original measure corresponding to an unrolled measure
+		const Sxmlelement&	source (int part, int index) const	{ return fSources[part][index]; }
+
+		//! browse the view with a visitor
+		void		browse (basevisitor& v) const;
+		//! creates a deep copy of the unrolled score
+		Sxmlelement	materialize () const;
+		//! serializes the view, without materializing the unrolled score
+		void		print (std::ostream& out) const;
+
+	protected:
+				 unrolled_view(const Sxmlelement& score);
+		virtual ~unrolled_view() {}
+
+	private:
+		Sxmlelement	fScore;
+		std::vector<Sxmlelement>				fParts;		///< the parts views
+		std::vector<std::vector<Sxmlelement> >	fSources;	///< the original measures, indexed as the parts views
+
+		// the current state, used to drop redundant key, clef and time elements
+		Sxmlelement	fCurrentKey, fCurrentClef, fCurrentTime;
+
+		Sxmlelement	shallowcopy (const Sxmlelement& elt, bool withattributes=true) const;
+		Sxmlelement	unroll	(const Sxmlelement& elt);
+		Sxmlelement	measure (const Sxmlelement& elt, long number);
+		Sxmlelement	part	(const Sxmlelement& elt, const std::vector<Sxmlelement>& measures);
+};
+
+/*! @} */
+
+} // namespace MusicXML2
+
+
+#endif
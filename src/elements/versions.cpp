@@ -21,8 +21,8 @@ const char*	versions::libVersionStr()			{ return "3.11"; }
 float		versions::xml2guidoVersion()		{ return 2.11; }
 const char*	versions::xml2guidoVersionStr()		{ return "2.11"; }
 
-//float		versions::xml2antescofoVersion()	{ return 0; }
-//const char*	versions::xml2antescofoVersionStr()	{ return "0"; }
+float		versions::xml2antescofoVersion()	{ return 1.0; }
+const char*	versions::xml2antescofoVersionStr()	{ return "1.0"; }
 
 }
 
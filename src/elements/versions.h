@@ -36,8 +36,8 @@ class EXP versions {
 		static float		xml2guidoVersion();
 		static const char*	xml2guidoVersionStr();
 		
-//		static float		xml2antescofoVersion();
-//		static const char*	xml2antescofoVersionStr();
+		static float		xml2antescofoVersion();
+		static const char*	xml2antescofoVersionStr();
 };
 
 }
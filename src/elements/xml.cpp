@@ -65,14 +65,15 @@ xmlattribute::operator float () const	{ return (float)atof(fValue.c_str()); }
 //______________________________________________________________________________
 Sxmlelement xmlelement::create()				{ xmlelement * o = new xmlelement; assert(o!=0); return o; }
 void xmlelement::setValue (int value)			{ setValue((long)value); }
-void xmlelement::setValue (const string& value) 	{ fValue = value; }
-void xmlelement::setName (const string& name) 		{ fName = name; }
+void xmlelement::setValue (const string& value) 	{ fValue = value; setModified(); }
+void xmlelement::setName (const string& name) 		{ fName = name; setModified(); }
 //______________________________________________________________________________
 void xmlelement::setValue (long value)
 {
 	stringstream s;
 	s << value;
 	s >> fValue;
+	setModified();
 }
 
 //______________________________________________________________________________
@@ -81,6 +82,7 @@ void xmlelement::setValue (unsigned long value)
 	stringstream s;
 	s << value;
 	s >> fValue;
+	setModified();
 }
 
 //______________________________________________________________________________
@@ -89,15 +91,43 @@ void xmlelement::setValue (float value)
 	stringstream s;
 	s << value;
 	s >> fValue;
+	setModified();
 }
 
 //______________________________________________________________________________
 long xmlelement::add (const Sxmlattribute& attr)
 { 
 	fAttributes.push_back(attr);
+	setModified();
 	return long(fAttributes.size()-1);
 }
 
+//______________________________________________________________________________
+// modification tracking
+// the ancestors of a modified element are modified: the propagation stops at the
+// first modified ancestor
+//______________________________________________________________________________
+void xmlelement::setModified ()
+{
+	for (xmlelement* e = this; e && !e->fModified; e = e->parent())
+		e->fModified = true;
+}
+
+// an element attached while it is still attached to another element is shared:
+// its modifications are not propagated to the previous element, which is marked
+// as modified so that its print finds the sharing (see xmlvisitor)
+void xmlelement::attached (const Sxmlelement& elt)
+{
+	xmlelement* previous = elt->parent();
+	if (previous && (previous != this)) previous->setModified();
+	setModified();
+}
+
+void xmlelement::detached (const Sxmlelement& elt)
+{
+	setModified();
+}
+
 //______________________________________________________________________________
 void xmlelement::acceptIn(basevisitor& v) {
 	visitor<Sxmlelement>* p = dynamic_cast<visitor<Sxmlelement>*>(&v);
@@ -80,6 +80,17 @@ class EXP xmlattribute : public smartable {
 	the lists of its attributes and its enclosed elements.
 	Attributes and elements must be added in the required
 	order.
+
+	An element is marked as modified by the changes of its name, value,
+	attributes list or sub-elements list, and the modification is propagated
+	to the element ancestors. The text of an unmodified element may be cached
+	by the xml serialization (see xmlvisitor), so that a document is printed
+	again by rendering only the modified elements.
+	The propagation follows the element the sub-element has been last attached
+	to (see ctree::parent). Attaching an element to a second element (e.g. a
+	shared time-modification) marks the first one as modified.
+	Changes made directly to the elements() vector or to the attributes
+	values are not tracked and require a call to setModified().
 */
 //______________________________________________________________________________
 class EXP xmlelement : public ctree<xmlelement>, public visitable
@@ -90,12 +101,14 @@ class EXP xmlelement : public ctree<xmlelement>, public visitable
 	std::string fValue;
 	//! list of the element attributes
 	std::vector<Sxmlattribute> fAttributes;
+	//! the modification state
+	bool		fModified;
 
     protected:
 		//! the element type
 		int	fType;
 
-				 xmlelement() : fType(0) {}
+				 xmlelement() : fModified(true), fType(0) {}
 		virtual ~xmlelement() {}
 
 	public:
@@ -151,6 +164,15 @@ class EXP xmlelement : public ctree<xmlelement>, public visitable
 
 		// misc
 		bool empty () const	{ return fValue.empty() && elements().empty(); }
+
+		// modification tracking
+		virtual void attached (const Sxmlelement& elt);
+		virtual void detached (const Sxmlelement& elt);
+		//! marks the element and its ancestors as modified
+		void		setModified ();
+		//! clears the modification state of the element
+		void		setClean ()				{ fModified = false; }
+		bool		modified () const		{ return fModified; }
 };
 
 /*! @} */
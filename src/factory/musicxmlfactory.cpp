@@ -39,10 +39,10 @@ musicxmlfactory::musicxmlfactory ()
 	fFile->set (fRoot);
 	
 	fIdentification = factory::instance().create(k_identification);
-	fRoot->push (fIdentification);
+	add (fRoot, fIdentification);
 	
 	fPartList = factory::instance().create(k_part_list);
-	fRoot->push (fPartList);
+	add (fRoot, fPartList);
 }
 
 //------------------------------------------------------------------------
@@ -50,8 +50,8 @@ Sxmlelement	musicxmlfactory::scorepart (const char* id, const char* name, const
 {
 	Sxmlelement part = element(k_score_part);
 	part->add (attribute("id", id));
-	if (name)			part->push (element(k_part_name, name));
-	if (abbrev)			part->push (element(k_part_abbreviation, abbrev));
+	if (name)			add (part, element(k_part_name, name));
+	if (abbrev)			add (part, element(k_part_abbreviation, abbrev));
 	return part;
 }
 
@@ -68,12 +68,12 @@ void musicxmlfactory::header (const char* worknumber, const char* worktitle, con
 {
 	if (worknumber || worktitle) {
 		Sxmlelement work = element(k_work);
-		if (worknumber) work->push (element(k_work_number, worknumber));
-		if (worktitle) work->push (element(k_work_title, worktitle));
-		fRoot->push (work);
+		if (worknumber) add (work, element(k_work_number, worknumber));
+		if (worktitle) add (work, element(k_work_title, worktitle));
+		add (fRoot, work);
 	}
-	if (movementnumber) fRoot->push (element(k_movement_number, movementnumber));
-	if (movementtitle) fRoot->push (element(k_movement_title, movementtitle));
+	if (movementnumber) add (fRoot, element(k_movement_number, movementnumber));
+	if (movementtitle) add (fRoot, element(k_movement_title, movementtitle));
 }
 
 //------------------------------------------------------------------------
@@ -81,7 +81,7 @@ void musicxmlfactory::creator (const char* c, const char* type)
 {
 	Sxmlelement creator = element(k_creator, c);
 	if (type) creator->add (attribute("type", type));
-	fIdentification->push (creator);
+	add (fIdentification, creator);
 }
 
 //------------------------------------------------------------------------
@@ -89,7 +89,7 @@ void musicxmlfactory::rights (const char* c, const char* type)
 {
 	Sxmlelement rights = element(k_rights, c);
 	if (type) rights->add (attribute("type", type));
-	fIdentification->push (rights);
+	add (fIdentification, rights);
 }
 
 //------------------------------------------------------------------------
@@ -105,27 +105,27 @@ Sxmlelement musicxmlfactory::newmeasure (int number, const char* time, const cha
 {
 	Sxmlelement m = newmeasure (number);
 	Sxmlelement attributes = getAttributes (m);
-	if (division) attributes->push (element(k_divisions, division));
+	if (division) add (attributes, element(k_divisions, division));
 	if (time) {
 		int beat, beatType;
 		int n = sscanf (time, "%d/%d", &beat, &beatType);
 		if (n == 2) {
 			Sxmlelement t = element (k_time);
-			t->push (element(k_beats, beat));
-			t->push (element(k_beat_type, beatType));
-			attributes->push (t);
+			add (t, element(k_beats, beat));
+			add (t, element(k_beat_type, beatType));
+			add (attributes, t);
 		}
 	}
 	if (clef) {
 		Sxmlelement c = element (k_clef);
-		c->push (element (k_sign, clef));
-		if (line) c->push (element (k_line, line));
-		attributes->push (c);
+		add (c, element (k_sign, clef));
+		if (line) add (c, element (k_line, line));
+		add (attributes, c);
 	}
 	if (key) {
 		Sxmlelement k = element (k_key);
-		k->push (element (k_fifths, key));
-		attributes->push (k);
+		add (k, element (k_fifths, key));
+		add (attributes, k);
 	}
 	return m;
 }
@@ -135,12 +135,12 @@ Sxmlelement musicxmlfactory::newnote (const char* step, float alter, int octave,
 {
 	Sxmlelement elt = element(k_note);
 	Sxmlelement pitch = element(k_pitch);
-	pitch->push (element (k_step, step));
-	if (alter) pitch->push (element (k_alter, alter));
-	pitch->push (element (k_octave, octave));
-	elt->push(pitch);
-	if (duration) elt->push(element(k_duration, duration));
-	if (type) elt->push(element(k_type, type));
+	add (pitch, element (k_step, step));
+	if (alter) add (pitch, element (k_alter, alter));
+	add (pitch, element (k_octave, octave));
+	add (elt, pitch);
+	if (duration) add (elt, element(k_duration, duration));
+	if (type) add (elt, element(k_type, type));
 	return elt;
 }
 
@@ -148,8 +148,9 @@ Sxmlelement musicxmlfactory::newnote (const char* step, float alter, int octave,
 Sxmlelement musicxmlfactory::newrest (int duration, const char* type)
 {
 	Sxmlelement elt = element(k_note);
-	if (duration) elt->push(element(k_duration, duration));
-	if (type) elt->push(element(k_type, type));
+	add (elt, element(k_rest));
+	if (duration) add (elt, element(k_duration, duration));
+	if (type) add (elt, element(k_type, type));
 	return elt;
 }
 
@@ -159,7 +160,7 @@ Sxmlelement musicxmlfactory::newdynamics (int type, const char* placement)
 	Sxmlelement dynamics = element (k_dynamics);
 	if (placement)
 		dynamics->add (attribute( "placement", placement));
-	dynamics->push (element(type));
+	add (dynamics, element(type));
 	return dynamics;
 }
 
@@ -170,11 +171,11 @@ Sxmlelement musicxmlfactory::newbarline (const char* location, const char* barst
 	if (location)
 		barline->add (attribute( "location", location));
 	if (barstyle)
-		barline->push (element(k_bar_style, barstyle));
+		add (barline, element(k_bar_style, barstyle));
 	if (repeat) {
 		Sxmlelement repeatelt = (element(k_repeat));
 		repeatelt->add (attribute( "direction", repeat));
-		barline->push (repeatelt);
+		add (barline, repeatelt);
 	}
 	return barline;
 }
@@ -186,7 +187,7 @@ void musicxmlfactory::makechord (const vector<Sxmlelement>& notes)
 	vector<Sxmlelement>::const_iterator i = notes.begin();
 	i++;								// skip first note
 	for (; i != notes.end(); i++)
-		(*i)->push(element(k_chord));
+		add (*i, element(k_chord));
 }
 
 //------------------------------------------------------------------------
@@ -194,51 +195,58 @@ void musicxmlfactory::maketuplet(int actual, int normal, const std::vector<Sxmle
 {
 	if (notes.empty()) return;
 	Sxmlelement timemod = element(k_time_modification);
-	timemod->push (element (k_actual_notes, actual));
-	timemod->push (element (k_normal_notes, normal));
+	add (timemod, element (k_actual_notes, actual));
+	add (timemod, element (k_normal_notes, normal));
 	for (unsigned int i=0; i < notes.size(); i++)
-		notes[i]->push(timemod);
+		add (notes[i], timemod);
 	Sxmlelement notations = getNotations (notes[0]);
 	Sxmlelement tuplet = element (k_tuplet);
 	tuplet->add (attribute ("type", "start"));
-	notations->push (tuplet);
+	add (notations, tuplet);
 
 	notations = getNotations (notes[notes.size()-1]);
 	tuplet = element (k_tuplet);
 	tuplet->add (attribute ("type", "stop"));
-	notations->push (tuplet);
+	add (notations, tuplet);
+}
+
+//------------------------------------------------------------------------
+void musicxmlfactory::addnotes (Sxmlelement measure, const TNote* notes, int count)
+{
+	measure->elements().reserve (measure->elements().size() + count);
+	for (int i = 0; i < count; i++) {
+		const TNote& n = notes[i];
+		Sxmlelement note;
+		if (n.step) note = newnote (n.step, n.alter, n.octave, n.duration, n.type);
+		else note = newrest (n.duration, n.type);
+		if (n.flags & kNoteChord)		add (note, element(k_chord));
+		if (n.voice)					add (note, element(k_voice, n.voice));
+		if (n.staff)					add (note, element(k_staff, n.staff));
+		if (n.flags & kNoteTieStop)		settie (note, "stop");
+		if (n.flags & kNoteTieStart)	settie (note, "start");
+		add (measure, note);
+	}
 }
 
 //------------------------------------------------------------------------
 void musicxmlfactory::tie (Sxmlelement start, Sxmlelement stop)
 {
-	Sxmlelement tieStart = element (k_tie);
-	tieStart->add (attribute ("type", "start"));
-	start->push (tieStart);
-	Sxmlelement tiedStart = element (k_tied);
-	tiedStart->add (attribute ("type", "start"));
-	addnotation (start, tiedStart);
-	
-	Sxmlelement tieStop = element (k_tie);
-	tieStop->add (attribute ("type", "stop"));
-	stop->push (tieStop);
-	Sxmlelement tiedStop = element (k_tied);
-	tiedStop->add (attribute ("type", "stop"));
-	addnotation (stop, tiedStop);
+	settie (start, "start");
+	settie (stop, "stop");
 }
 
 //------------------------------------------------------------------------
 void musicxmlfactory::addnotation (Sxmlelement elt, Sxmlelement notation)
 {
 	Sxmlelement notations = getNotations (elt);
-	notations->push (notation);
+	add (notations, notation);
 }
 
 //------------------------------------------------------------------------
 void musicxmlfactory::addarticulation (Sxmlelement elt, Sxmlelement articulation)
 {
 	Sxmlelement articulations = getArticulations (elt);
-	articulations->push (articulation);
+	add (articulations, articulation);
 }
 
 //------------------------------------------------------------------------
@@ -247,10 +255,10 @@ void musicxmlfactory::addgroup (int number, const char* name, const char* abbrev
 	Sxmlelement groupStart = element(k_part_group);
 	groupStart->add (attribute ("number", number));
 	groupStart->add (attribute ("type", "start"));
-	if (name)			groupStart->push (element(k_group_name, name));
-	if (abbrev)			groupStart->push (element(k_group_abbreviation, abbrev));
-	if (groupbarline)	groupStart->push (element(k_group_barline, "yes"));
-	fPartList->push (groupStart);
+	if (name)			add (groupStart, element(k_group_name, name));
+	if (abbrev)			add (groupStart, element(k_group_abbreviation, abbrev));
+	if (groupbarline)	add (groupStart, element(k_group_barline, "yes"));
+	add (fPartList, groupStart);
 
 	for (vector<Sxmlelement>::const_iterator i = parts.begin(); i != parts.end(); i++)
 		addpart(*i);
@@ -258,7 +266,7 @@ void musicxmlfactory::addgroup (int number, const char* name, const char* abbrev
 	Sxmlelement groupStop = element(k_part_group);
 	groupStop->add (attribute ("number", number));
 	groupStop->add (attribute ("type", "stop"));
-	fPartList->push (groupStop);	
+	add (fPartList, groupStop);
 }
 
 //------------------------------------------------------------------------
@@ -266,10 +274,10 @@ void musicxmlfactory::addpart (const Sxmlelement& part)
 { 
 	switch (part->getType()) {
 		case k_score_part:
-			fPartList->push(part);
+			add (fPartList, part);
 			break;
 		case k_part:
-			fRoot->push(part);
+			add (fRoot, part);
 			break;
 		default:
 			cerr << "musicxmlfactory::addpart unexpected type " <<  part->getType() << endl;
@@ -280,7 +288,15 @@ void musicxmlfactory::addpart (const Sxmlelement& part)
 void musicxmlfactory::add (Sxmlelement elt, const std::vector<Sxmlelement>& subelts) const
 {
 	for (unsigned int i=0; i < subelts.size(); i++) 
-		elt->push( subelts[i]);
+		add (elt, subelts[i]);
+}
+
+//------------------------------------------------------------------------
+// sub elements are inserted at their place according to the dtd
+// the tree is thus always sorted
+void musicxmlfactory::add (Sxmlelement elt, const Sxmlelement& subelt) const
+{
+	sortvisitor::insert (elt, subelt);
 }
 
 //------------------------------------------------------------------------
@@ -317,17 +333,15 @@ static const char * timestring ()
 void musicxmlfactory::encoding(const char* software)
 {
 	Sxmlelement encoding = element (k_encoding);
-	if (software) encoding->push (element(k_software, software));
+	if (software) add (encoding, element(k_software, software));
 
 	string lib = "MusicXML Library version ";
 	lib += musicxmllibVersionStr();
-	encoding->push (element(k_software, lib.c_str()));
-	encoding->push (element (k_encoding_date, timestring()));
-	fIdentification->push (encoding);
+	add (encoding, element(k_software, lib.c_str()));
+	add (encoding, element (k_encoding_date, timestring()));
+	add (fIdentification, encoding);
 }
 
-//------------------------------------------------------------------------
-// protected methods
 //------------------------------------------------------------------------
 void musicxmlfactory::sort()
 {
@@ -336,6 +350,19 @@ void musicxmlfactory::sort()
 	browser.browse(*fRoot);
 }
 
+//------------------------------------------------------------------------
+// protected methods
+//------------------------------------------------------------------------
+void musicxmlfactory::settie (Sxmlelement note, const char* type)
+{
+	Sxmlelement tie = element (k_tie);
+	tie->add (attribute ("type", type));
+	add (note, tie);
+	Sxmlelement tied = element (k_tied);
+	tied->add (attribute ("type", type));
+	addnotation (note, tied);
+}
+
 //------------------------------------------------------------------------
 Sxmlelement	musicxmlfactory::getSubElement (Sxmlelement elt, int type) const
 {
@@ -345,7 +372,7 @@ Sxmlelement	musicxmlfactory::getSubElement (Sxmlelement elt, int type) const
 			return subelts[i];
 	}
 	Sxmlelement sub = element(type);
-	elt->push (sub);
+	add (elt, sub);
 	return sub;
 }
 
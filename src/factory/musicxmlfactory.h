@@ -16,6 +16,7 @@
 #include <vector>
 #include "xmlfile.h"
 #include "elements.h"
+#include "libmusicxml.h"
 
 using namespace std;
 namespace MusicXML2
@@ -31,8 +32,8 @@ class musicxmlfactory
 		Sxmlelement	fPartList;
 
 	protected:
-		void			sort ();
 		Sxmlelement		getSubElement (Sxmlelement elt, int type) const;
+		void			settie (Sxmlelement note, const char* type);
 		Sxmlelement		getNotations (Sxmlelement elt) const		{ return getSubElement (elt, MusicXML2::k_notations); }
 		Sxmlelement		getAttributes (Sxmlelement elt) const		{ return getSubElement (elt, MusicXML2::k_attributes); }
 		Sxmlelement		getArticulations (Sxmlelement elt) const	{ return getSubElement (getNotations(elt), MusicXML2::k_articulations); }
@@ -68,12 +69,13 @@ class musicxmlfactory
 
 		virtual void		makechord (const std::vector<Sxmlelement>& notes);
 		virtual void		maketuplet (int actual, int normal, const std::vector<Sxmlelement>& notes);
+		virtual void		addnotes (Sxmlelement measure, const TNote* notes, int count);
 		virtual void		tie (Sxmlelement start, Sxmlelement end);
 		virtual void		addnotation (Sxmlelement elt, Sxmlelement notation);
 		virtual void		addarticulation (Sxmlelement elt, Sxmlelement articulation);
 
 		virtual void add (Sxmlelement elt, const std::vector<Sxmlelement>& subelts) const;
-		virtual void add (Sxmlelement elt, const Sxmlelement& subelt) const		{ elt->push (subelt); }
+		virtual void add (Sxmlelement elt, const Sxmlelement& subelt) const;
 		virtual void add (Sxmlelement elt, const Sxmlattribute& attr) const		{ elt->add (attr); }
 
 		virtual Sxmlelement		element(int type, const char * value=0) const;
@@ -86,6 +88,10 @@ class musicxmlfactory
 													return attribute;
 												}
 
+		// elements added using the factory are inserted at their place according to the dtd
+		// the tree is still sorted on output, in case it has been modified by other means:
+		// a sorted tree is only checked and left untouched (see sortvisitor)
+		virtual void			sort ();
 		virtual void			print (std::ostream& s) 	{ sort(); fFile->print(s); }
 		virtual Sxmlelement		getElements() 				{ sort(); return fRoot; }
 };
@@ -0,0 +1,303 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdio.h>
+#include <vector>
+
+#include "scoregenerator.h"
+#include "xmlvisitor.h"
+
+using namespace std;
+namespace MusicXML2
+{
+
+#define kDivisions	12					// allows quarters, eighths and eighth triplets
+#define kMeasure	(4 * kDivisions)	// 4/4 measures
+
+static const char* gSteps[] = { "C", "D", "E", "F", "G", "A", "B" };
+static const char* gSyllables[] = { "la", "li", "lo", "da", "di", "do", "na", "ne", "mi", "so" };
+
+//------------------------------------------------------------------------
+// a xorshift random generator seeded by the score seed, a part and a measure:
+// the sequence is the same on every platform and a measure can be built
+// independently of the others
+//------------------------------------------------------------------------
+class rng {
+	unsigned int fState;
+
+	static unsigned int mix (unsigned int h) {
+		h ^= h >> 16; h *= 0x85ebca6b;
+		h ^= h >> 13; h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	public:
+				 rng (unsigned long seed, int part, int measure) {
+					fState = mix (mix (mix ((unsigned int)seed) ^ (unsigned int)part) ^ (unsigned int)measure);
+					if (!fState) fState = 1;
+				 }
+
+		unsigned int next () {
+			fState ^= fState << 13;
+			fState ^= fState >> 17;
+			fState ^= fState << 5;
+			return fState;
+		}
+		int		get (int range)			{ return int(next() % (unsigned int)range); }
+		bool	chance (int percent)	{ return get(100) < percent; }
+};
+
+static string partID (int part)
+{
+	char buff[32];
+	sprintf (buff, "P%d", part);
+	return buff;
+}
+
+//------------------------------------------------------------------------
+// public methods
+//------------------------------------------------------------------------
+scoregenerator::settings scoregenerator::defaults ()
+{
+	settings s;
+	s.fSeed = 1;
+	s.fParts = 1;
+	s.fStaves = 1;
+	s.fVoices = 1;
+	s.fMeasures = 20;
+	s.fChords = 0;
+	s.fTuplets = 0;
+	s.fRepeats = 0;
+	s.fJumps = false;
+	s.fLyrics = false;
+	return s;
+}
+
+//------------------------------------------------------------------------
+SXMLFile scoregenerator::score ()
+{
+	musicxmlfactory f;
+	header (f);
+	for (int p = 1; p <= fSettings.fParts; p++) {
+		Sxmlelement part = f.part (partID(p).c_str());
+		for (int m = 1; m <= fSettings.fMeasures; m++)
+			f.add (part, measure (p, m));
+		f.addpart (part);
+	}
+	SXMLFile file = TXMLFile::create();
+	file->set (new TXMLDecl("1.0", "", TXMLDecl::kNo));
+	file->set (new TDocType("score-partwise"));
+	file->set (f.root());
+	return file;
+}
+
+//------------------------------------------------------------------------
+// the parts start and end tags are printed by the visitor, the other
+// measures are released once printed
+void scoregenerator::write (ostream& out)
+{
+	musicxmlfactory f;
+	header (f);
+	TXMLDecl("1.0", "", TXMLDecl::kNo).print (out);
+	TDocType("score-partwise").print (out);
+
+	xmlvisitor v(out);
+	Sxmlelement root = f.root();
+	v.visitStart (root);
+	for (ctree<xmlelement>::literator i = root->lbegin(); i != root->lend(); i++)
+		v.print (*i);
+	for (int p = 1; p <= fSettings.fParts; p++) {
+		Sxmlelement part = f.part (partID(p).c_str());
+		Sxmlelement first;
+		if (fSettings.fMeasures > 0) {
+			first = measure (p, 1);
+			f.add (part, first);		// the part is not empty: the visitor prints its start tag
+		}
+		v.visitStart (part);
+		if (first) v.print (first);
+		for (int m = 2; m <= fSettings.fMeasures; m++)
+			v.print (measure (p, m));
+		v.visitEnd (part);
+	}
+	v.visitEnd (root);
+}
+
+//------------------------------------------------------------------------
+Sxmlelement scoregenerator::measure (int part, int number)
+{
+	rng r (fSettings.fSeed, part, number);
+	int last = fSettings.fMeasures;
+	Sxmlelement m = fFactory.newmeasure (number);
+	if (number == 1) fFactory.add (m, attributes (part));
+
+	// the jumps: segno ... to coda ... dal segno, coda ...
+	bool jumps = fSettings.fJumps && (last >= 4);
+	int segno = last / 4 + 1, tocoda = last / 2, dalsegno = (3 * last) / 4;
+
+	// the repeated sections, a last incomplete section is not repeated
+	// a section starting with a segno or a coda is not repeated either: the unrolled
+	// browser stores a single location per measure, the forward repeat would be lost
+	int len = fSettings.fRepeats;
+	int start = (len > 0) ? ((number - 1) / len) * len + 1 : 0;
+	bool repeat = (len > 0) && (start + len - 1 <= last);
+	if (jumps && ((start == segno) || (start == dalsegno + 1))) repeat = false;
+	if (repeat && (number == start))
+		fFactory.add (m, fFactory.newbarline ("left", "heavy-light", "forward"));
+
+	if (jumps && (number == segno))			fFactory.add (m, direction (k_segno, 0, "segno", "segno"));
+	if (jumps && (number == dalsegno + 1))	fFactory.add (m, direction (k_coda, 0, "coda", "coda"));
+
+	int staves = fSettings.fStaves, voices = fSettings.fVoices;
+	for (int staff = 1; staff <= staves; staff++) {
+		for (int v = 1; v <= voices; v++) {
+			if ((staff > 1) || (v > 1)) {
+				Sxmlelement backup = fFactory.element (k_backup);
+				fFactory.add (backup, fFactory.element (k_duration, kMeasure));
+				fFactory.add (m, backup);
+			}
+			int voice = (staff - 1) * voices + v;
+			// treble staves around the 4th octave, bass staves around the 2nd one
+			int base = ((staff % 2) ? 4 * 7 + 2 : 2 * 7 + 4) - (v - 1) * 3;
+			bool lyrics = fSettings.fLyrics && (staff == 1) && (v == 1);
+			int beat = 0;
+			while (beat < 4) {
+				vector<Sxmlelement> notes;
+				int duration = kDivisions, count = 1;
+				const char* type = "quarter";
+				bool tuplet = r.chance (fSettings.fTuplets);
+				bool rest = false;
+				if (tuplet) { duration = kDivisions / 3; count = 3; type = "eighth"; }
+				else switch (r.get(4)) {
+					case 1:	duration = kDivisions / 2; count = 2; type = "eighth"; break;
+					case 2:	if (beat < 3) { duration = 2 * kDivisions; type = "half"; } break;
+					case 3:	rest = true; break;
+				}
+				for (int i = 0; i < count; i++) {
+					if (rest) {
+						fFactory.add (m, note (staff, voice, duration, type, -1, 0, false));
+						continue;
+					}
+					int pitch = base + r.get(8);
+					int alter = r.chance(10) ? (r.get(2) ? 1 : -1) : 0;
+					Sxmlelement n = note (staff, voice, duration, type, pitch, alter, false);
+					if (lyrics) {
+						Sxmlelement lyric = fFactory.element (k_lyric);
+						lyric->add (fFactory.attribute ("number", 1));
+						fFactory.add (lyric, fFactory.element (k_syllabic, "single"));
+						fFactory.add (lyric, fFactory.element (k_text, gSyllables[r.get(10)]));
+						fFactory.add (n, lyric);
+					}
+					fFactory.add (m, n);
+					notes.push_back (n);
+					if (!tuplet && r.chance (fSettings.fChords)) {
+						int size = 1 + r.get(2);
+						for (int c = 1; c <= size; c++)
+							fFactory.add (m, note (staff, voice, duration, type, pitch + 2 * c, 0, true));
+					}
+				}
+				if (tuplet) fFactory.maketuplet (3, 2, notes);
+				beat += (duration * count) / kDivisions;
+			}
+		}
+	}
+
+	if (jumps && (number == tocoda))		fFactory.add (m, direction (k_words, "To Coda", "tocoda", "coda"));
+	if (jumps && (number == dalsegno))		fFactory.add (m, direction (k_words, "D.S. al Coda", "dalsegno", "segno"));
+	if (repeat && (number == start + len - 1))
+		fFactory.add (m, fFactory.newbarline ("right", "light-heavy", "backward"));
+	else if (number == last)
+		fFactory.add (m, fFactory.newbarline ("right", "light-heavy"));
+	return m;
+}
+
+//------------------------------------------------------------------------
+// private methods
+//------------------------------------------------------------------------
+void scoregenerator::header (musicxmlfactory& f)
+{
+	f.header (0, 0, 0, "Synthetic score");
+	f.creator ("scoregenerator", "composer");
+	// the encoding date is omitted to keep the output deterministic
+	Sxmlelement encoding = f.element (k_encoding);
+	f.add (encoding, f.element (k_software, "MusicXML Library scoregenerator"));
+	f.add (f.identification(), encoding);
+	for (int p = 1; p <= fSettings.fParts; p++) {
+		string name = "Part " + partID(p).substr(1);
+		f.addpart (f.scorepart (partID(p).c_str(), name.c_str(), 0));
+	}
+}
+
+//------------------------------------------------------------------------
+Sxmlelement scoregenerator::attributes (int part)
+{
+	rng r (fSettings.fSeed, part, 0);
+	Sxmlelement attr = fFactory.element (k_attributes);
+	fFactory.add (attr, fFactory.element (k_divisions, kDivisions));
+	Sxmlelement key = fFactory.element (k_key);
+	Sxmlelement fifths = fFactory.element (k_fifths);
+	fifths->setValue (r.get(7) - 3);
+	fFactory.add (key, fifths);
+	fFactory.add (attr, key);
+	Sxmlelement time = fFactory.element (k_time);
+	fFactory.add (time, fFactory.element (k_beats, 4));
+	fFactory.add (time, fFactory.element (k_beat_type, 4));
+	fFactory.add (attr, time);
+	int staves = fSettings.fStaves;
+	if (staves > 1) fFactory.add (attr, fFactory.element (k_staves, staves));
+	for (int s = 1; s <= staves; s++) {
+		Sxmlelement clef = fFactory.element (k_clef);
+		if (staves > 1) clef->add (fFactory.attribute ("number", s));
+		bool treble = (s % 2) != 0;
+		fFactory.add (clef, fFactory.element (k_sign, treble ? "G" : "F"));
+		fFactory.add (clef, fFactory.element (k_line, treble ? 2 : 4));
+		fFactory.add (attr, clef);
+	}
+	return attr;
+}
+
+//------------------------------------------------------------------------
+Sxmlelement scoregenerator::direction (int sign, const char* words, const char* sound, const char* value)
+{
+	Sxmlelement dir = fFactory.element (k_direction);
+	dir->add (fFactory.attribute ("placement", "above"));
+	Sxmlelement type = fFactory.element (k_direction_type);
+	fFactory.add (type, fFactory.element (sign, words));
+	fFactory.add (dir, type);
+	Sxmlelement s = fFactory.element (k_sound);
+	s->add (fFactory.attribute (sound, value));
+	fFactory.add (dir, s);
+	return dir;
+}
+
+//------------------------------------------------------------------------
+// a negative pitch denotes a rest, pitches are diatonic steps from C0
+Sxmlelement scoregenerator::note (int staff, int voice, int duration, const char* type, int pitch, int alter, bool chord)
+{
+	Sxmlelement n;
+	if (pitch < 0) {
+		n = fFactory.newrest (duration, type);
+	}
+	else {
+		n = fFactory.newnote (gSteps[pitch % 7], float(alter), pitch / 7, duration, type);
+		if (chord) fFactory.add (n, fFactory.element (k_chord));
+	}
+	fFactory.add (n, fFactory.element (k_voice, voice));
+	if (fSettings.fStaves > 1) fFactory.add (n, fFactory.element (k_staff, staff));
+	return n;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __scoregenerator__
+#define __scoregenerator__
+
+#include <ostream>
+
+#include "exports.h"
+#include "musicxmlfactory.h"
+#include "xmlfile.h"
+
+namespace MusicXML2
+{
+
+//------------------------------------------------------------------------
+/*!
+\brief A synthetic scores generator, intended for scalability benchmarks.
+
+	The generator builds 4/4 partwise scores with the musicxmlfactory. The parts,
+	staves, voices and measures counts, the chords and tuplets densities, the
+	repeats, jumps and lyrics are set by the generator settings.
+
+	The output is deterministic: a measure content depends only on the seed, the
+	part and the measure number. A score can thus be written measure by measure
+	(see write()): the memory use doesn't depend on the score size.
+*/
+class EXP scoregenerator
+{
+	public:
+		typedef struct {
+			unsigned long	fSeed;
+			int		fParts;
+			int		fStaves;		///< the staves count per part
+			int		fVoices;		///< the voices count per staff
+			int		fMeasures;		///< the measures count per part
+			int		fChords;		///< the percentage of notes that are chords, tuplets excluded
+			int		fTuplets;		///< the percentage of beats that are triplets
+			int		fRepeats;		///< the length of the repeated sections in measures, 0 for none
+			bool	fJumps;			///< adds a segno, a 'to coda', a 'dal segno' and a coda to each part
+			bool	fLyrics;		///< adds lyrics to the first voice of each part
+		} settings;
+
+				 scoregenerator (const settings& s) : fSettings(s) {}
+		virtual ~scoregenerator() {}
+
+		//! gives the default settings: a single part of 20 measures, with 1 staff and 1 voice
+		static settings	defaults ();
+		const settings&	getSettings () const		{ return fSettings; }
+
+		//! builds a whole score in memory
+		SXMLFile	score ();
+		//! writes the score measure by measure, the output is the same as printing score()
+		void		write (std::ostream& out);
+		//! builds a part measure, parts and measures are numbered from 1
+		Sxmlelement	measure (int part, int number);
+
+	private:
+		settings		fSettings;
+		musicxmlfactory	fFactory;
+
+		void		header (musicxmlfactory& f);
+		Sxmlelement	attributes (int part);
+		Sxmlelement	direction (int sign, const char* words, const char* sound, const char* value);
+		Sxmlelement	note (int staff, int voice, int duration, const char* type, int pitch, int alter, bool chord);
+};
+
+}
+
+#endif
@@ -87,6 +87,12 @@ class sortvisitor :
 	public:
 				 sortvisitor();
        	virtual ~sortvisitor() {}
+
+		/*! inserts an element in a container at its place according to the dtd:
+			a container built using insert is always sorted.
+			Elements unknown to the container order are put at the end.
+		*/
+		static void insert (const Sxmlelement& container, const Sxmlelement& elt);
               
 		virtual void visitStart( S_accord& elt );
 		virtual void visitStart( S_accordion_registration& elt );
@@ -0,0 +1,586 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+#ifdef WIN32
+# define NOMMAP
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include "corpusindex.h"
+#include "doccache.h"
+#include "keysignvisitor.h"
+#include "partsummary.h"
+#include "readerinternals.h"
+#include "timesignvisitor.h"
+#include "xml_tree_browser.h"
+#include "xmlprobe.h"
+#include "xmlreader.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// the index file format: the values are stored in the native byte order
+//	- a header: the magic string, the format version, the columns count and the rows count
+//	- the columns offsets
+//	- the columns, aligned on 8 bytes: a numeric column is an array of values,
+//	  a string column is an array of rows + 1 offsets followed by the characters
+//______________________________________________________________________________
+static const char*	kMagic = "MXLINDEX";
+enum { kFormatVersion = 2 };		// version 2: the modification times are in nanoseconds
+
+enum {	kPath, kTitle, kComposer, kVersion, kParts, kInstruments, kMode, kTime, kStringColumns,
+		kMTime = kStringColumns, kSize, kHash, kLongColumns,
+		kPartsCount = kLongColumns, kStaves, kVoices, kMeasures, kNotes, kLowest, kHighest, kFifths, kColumnsCount };
+
+typedef struct {
+	char				fMagic[8];
+	unsigned int		fVersion;
+	unsigned int		fColumns;
+	unsigned long long	fRows;
+} indexheader;
+
+//______________________________________________________________________________
+// the features visitor
+//______________________________________________________________________________
+class featuresvisitor :
+	public partsummary,
+	public keysignvisitor,
+	public timesignvisitor,
+	public visitor<S_measure>
+{
+	scorefeatures&	fFeatures;
+	int				fPartMeasures;
+	bool			fKey, fTime;		// the first key and time signatures are found
+
+	protected:
+		void visitStart	( S_part& elt)		{ partsummary::visitStart (elt); fPartMeasures = 0; }
+		void visitEnd	( S_part& elt) {
+			fFeatures.fStaves += countStaves();
+			fFeatures.fVoices += countVoices();
+			if (fPartMeasures > fFeatures.fMeasures) fFeatures.fMeasures = fPartMeasures;
+		}
+		void visitStart	( S_measure& elt)	{ fPartMeasures++; }
+		void visitEnd	( S_key& elt) {
+			if (fKey) return;
+			fFeatures.fFifths = fFifths;
+			fFeatures.fMode = fMode;
+			fKey = true;
+		}
+		void visitEnd	( S_time& elt) {
+			if (fTime || fTimeSign.empty()) return;
+			fFeatures.fTime = fTimeSign[0].first + "/" + fTimeSign[0].second;
+			fTime = true;
+		}
+		void visitEnd	( S_note& elt) {
+			partsummary::visitEnd (elt);
+			if (getType() == kRest) return;
+			fFeatures.fNotes++;
+			if (getType() != kPitched) return;
+			int pitch = int(getMidiKey() + 0.5f);
+			if ((fFeatures.fLowest < 0) || (pitch < fFeatures.fLowest)) fFeatures.fLowest = pitch;
+			if (pitch > fFeatures.fHighest) fFeatures.fHighest = pitch;
+		}
+
+	public:
+				 featuresvisitor(scorefeatures& f) : fFeatures(f), fPartMeasures(0), fKey(false), fTime(false) {}
+		virtual ~featuresvisitor() {}
+};
+
+//______________________________________________________________________________
+// files utilities
+//______________________________________________________________________________
+// the modification time is in nanoseconds, with the file system resolution
+static bool filestat (const char* file, unsigned long long& mtime, unsigned long long& size)
+{
+	struct stat s;
+	if (stat (file, &s)) return false;
+#if defined(__APPLE__)
+	mtime = (unsigned long long)s.st_mtimespec.tv_sec * 1000000000ULL + (unsigned long long)s.st_mtimespec.tv_nsec;
+#elif defined(WIN32)
+	mtime = (unsigned long long)s.st_mtime * 1000000000ULL;
+#else
+	mtime = (unsigned long long)s.st_mtim.tv_sec * 1000000000ULL + (unsigned long long)s.st_mtim.tv_nsec;
+#endif
+	size = (unsigned long long)s.st_size;
+	return true;
+}
+
+static std::string join (const vector<std::string>& list)
+{
+	std::string out;
+	for (size_t i = 0; i < list.size(); i++)
+		out += (i ? "\n" : "") + list[i];
+	return out;
+}
+
+// the content hashed by the caller is parsed (the reads are serialized by the
+// parser lock), the header fields are collected from the tree and the analysis
+// of the tree runs concurrently
+static bool analyse (const std::string& content, scorefeatures& f)
+{
+	xmlreader r;
+	SXMLFile xml = r.readcontent (content);
+	if (!xml || !xml->elements()) return false;
+	scoremetadata meta;
+	xmlprobe probe;
+	if (!probe.probe (xml, meta)) return false;
+
+	f.fTitle = meta.title();
+	f.fComposer = meta.composer();
+	f.fVersion = meta.fVersion;
+	vector<std::string> parts, instruments;
+	for (vector<scoremetadata::part>::const_iterator i = meta.fParts.begin(); i != meta.fParts.end(); i++) {
+		parts.push_back (i->fName);
+		instruments.insert (instruments.end(), i->fInstruments.begin(), i->fInstruments.end());
+	}
+	f.fParts = join (parts);
+	f.fInstruments = join (instruments);
+	f.fPartsCount = int(meta.fParts.size());
+	f.fStaves = f.fVoices = f.fMeasures = f.fNotes = f.fFifths = 0;
+	f.fLowest = f.fHighest = -1;
+	f.fMode.clear();
+	f.fTime.clear();
+
+	featuresvisitor v (f);
+	xml_tree_browser browser (&v);
+	browser.browse (*xml->elements());
+	return true;
+}
+
+//______________________________________________________________________________
+// corpusindex
+//______________________________________________________________________________
+corpusindex::corpusindex() : fData(0), fDataSize(0), fMapped(false), fRows(0), fWriteTime(0) {}
+corpusindex::~corpusindex()		{ close(); }
+
+void corpusindex::close ()
+{
+	if (fData) {
+#ifndef NOMMAP
+		if (fMapped) munmap ((void*)fData, fDataSize);
+		else
+#endif
+		delete[] fData;
+	}
+	fData = 0;
+	fDataSize = fRows = 0;
+	fWriteTime = 0;
+	fMapped = false;
+	fColumns.clear();
+}
+
+// the string offsets must start at 0, be increasing and the characters must
+// fit the remaining bytes (size)
+static bool consistent (const unsigned long long* offsets, unsigned long long rows, unsigned long long size)
+{
+	if (offsets[0] != 0) return false;
+	for (unsigned long long i = 0; i < rows; i++)
+		if (offsets[i] > offsets[i+1]) return false;
+	return offsets[rows] <= size;
+}
+
+bool corpusindex::open (const char* file)
+{
+	close();
+	unsigned long long size;
+	if (!filestat (file, fWriteTime, size)) return false;
+#ifndef NOMMAP
+	int fd = ::open (file, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat s;
+	if (!fstat (fd, &s) && (s.st_size > 0)) {
+		void* data = mmap (0, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (data != MAP_FAILED) {
+			fData = (const char*)data;
+			fDataSize = (unsigned long)s.st_size;
+			fMapped = true;
+		}
+	}
+	::close (fd);
+#else
+	std::string content;
+	if (readcontent (file, content) && content.size()) {
+		char* data = new char[content.size()];
+		memcpy (data, content.data(), content.size());
+		fData = data;
+		fDataSize = (unsigned long)content.size();
+	}
+#endif
+	if (!fData) return false;
+
+	const indexheader* h = (const indexheader*)fData;
+	unsigned long long headsize = sizeof(indexheader) + kColumnsCount * sizeof(unsigned long long);
+	if ((fDataSize < headsize) || strncmp (h->fMagic, kMagic, 8) || (h->fVersion != kFormatVersion) || (h->fColumns != kColumnsCount)) {
+		close();
+		return false;
+	}
+	if (h->fRows >= fDataSize / sizeof(unsigned long long)) {
+		close();
+		return false;
+	}
+	fRows = (unsigned long)h->fRows;
+	// the columns are aligned, ordered and don't overlap
+	const unsigned long long* offsets = (const unsigned long long*)(fData + sizeof(indexheader));
+	unsigned long long start = headsize;
+	for (int i = 0; i < kColumnsCount; i++) {
+		unsigned long long width = (i < kStringColumns) ? sizeof(unsigned long long) * (fRows + 1) : (i < kLongColumns) ? sizeof(unsigned long long) * fRows : sizeof(int) * fRows;
+		if ((offsets[i] < start) || (offsets[i] % 8) || (offsets[i] > fDataSize) || (width > fDataSize - offsets[i])) {
+			close();
+			return false;
+		}
+		start = offsets[i] + width;
+		if (i < kStringColumns) {
+			const unsigned long long* strings = (const unsigned long long*)(fData + offsets[i]);
+			if (!consistent (strings, fRows, fDataSize - start)) {
+				close();
+				return false;
+			}
+			start += strings[fRows];
+		}
+		fColumns.push_back (fData + offsets[i]);
+	}
+	return true;
+}
+
+//______________________________________________________________________________
+const char* corpusindex::str (int column, unsigned long row, unsigned long& length) const
+{
+	const unsigned long long* offsets = (const unsigned long long*)fColumns[column];
+	const char* chars = (const char*)(offsets + fRows + 1);
+	length = (unsigned long)(offsets[row+1] - offsets[row]);
+	return chars + offsets[row];
+}
+
+std::string corpusindex::text (int column, unsigned long row) const
+{
+	unsigned long length;
+	const char* s = str (column, row, length);
+	return std::string (s, length);
+}
+
+std::string corpusindex::path (unsigned long row) const	{ return text (kPath, row); }
+
+void corpusindex::get (unsigned long row, scorefeatures& f) const
+{
+	f.fPath			= text (kPath, row);
+	f.fTitle		= text (kTitle, row);
+	f.fComposer		= text (kComposer, row);
+	f.fVersion		= text (kVersion, row);
+	f.fParts		= text (kParts, row);
+	f.fInstruments	= text (kInstruments, row);
+	f.fMode			= text (kMode, row);
+	f.fTime			= text (kTime, row);
+	f.fMTime		= value<unsigned long long> (kMTime, row);
+	f.fSize			= value<unsigned long long> (kSize, row);
+	f.fHash			= value<unsigned long long> (kHash, row);
+	f.fPartsCount	= value<int> (kPartsCount, row);
+	f.fStaves		= value<int> (kStaves, row);
+	f.fVoices		= value<int> (kVoices, row);
+	f.fMeasures		= value<int> (kMeasures, row);
+	f.fNotes		= value<int> (kNotes, row);
+	f.fLowest		= value<int> (kLowest, row);
+	f.fHighest		= value<int> (kHighest, row);
+	f.fFifths		= value<int> (kFifths, row);
+}
+
+//______________________________________________________________________________
+// case insensitive search of a lower case pattern
+static bool contains (const char* s, unsigned long length, const std::string& pattern)
+{
+	size_t n = pattern.size();
+	if (!n) return true;
+	for (unsigned long i = 0; i + n <= length; i++) {
+		size_t j = 0;
+		while ((j < n) && (tolower((unsigned char)s[i+j]) == pattern[j])) j++;
+		if (j == n) return true;
+	}
+	return false;
+}
+
+static std::string lower (const std::string& s)
+{
+	std::string out (s);
+	for (size_t i = 0; i < out.size(); i++) out[i] = (char)tolower ((unsigned char)out[i]);
+	return out;
+}
+
+void corpusindex::query (const corpusquery& q, vector<unsigned long>& rows) const
+{
+	std::string composer = lower (q.fComposer);
+	std::string title = lower (q.fTitle);
+	std::string instrument = lower (q.fInstrument);
+	bool range = (q.fLowest > 0) || (q.fHighest < 127);
+	const int* measures = (const int*)fColumns[kMeasures];
+	const int* fifths = (const int*)fColumns[kFifths];
+	const int* lowest = (const int*)fColumns[kLowest];
+	const int* highest = (const int*)fColumns[kHighest];
+
+	unsigned long length;
+	const char* s;
+	for (unsigned long i = 0; i < fRows; i++) {
+		if ((measures[i] < q.fMinMeasures) || (measures[i] > q.fMaxMeasures)) continue;
+		if ((q.fFifths != corpusquery::kAnyKey) && (fifths[i] != q.fFifths)) continue;
+		if (range && ((lowest[i] < 0) || (lowest[i] < q.fLowest) || (highest[i] > q.fHighest))) continue;
+		if (q.fMode.size()) {
+			s = str (kMode, i, length);
+			if ((length != q.fMode.size()) || strncmp (s, q.fMode.c_str(), length)) continue;
+		}
+		if (q.fTime.size()) {
+			s = str (kTime, i, length);
+			if ((length != q.fTime.size()) || strncmp (s, q.fTime.c_str(), length)) continue;
+		}
+		if (composer.size()) {
+			s = str (kComposer, i, length);
+			if (!contains (s, length, composer)) continue;
+		}
+		if (title.size()) {
+			s = str (kTitle, i, length);
+			if (!contains (s, length, title)) continue;
+		}
+		if (instrument.size()) {
+			s = str (kParts, i, length);
+			if (!contains (s, length, instrument)) {
+				s = str (kInstruments, i, length);
+				if (!contains (s, length, instrument)) continue;
+			}
+		}
+		rows.push_back (i);
+	}
+}
+
+//______________________________________________________________________________
+bool corpusindex::features (const char* file, scorefeatures& f)
+{
+	std::string content;
+	if (!filestat (file, f.fMTime, f.fSize) || !readcontent (file, content)) return false;
+	f.fPath = file;
+	f.fHash = doccache::hash (content.data(), content.size());
+	return analyse (content, f);
+}
+
+enum { kFailed, kUnchanged, kSameContent, kParsed };
+
+corpusindex::updatestats corpusindex::update (const vector<std::string>& files, int workers, vector<scorefeatures>& out) const
+{
+	unordered_map<std::string, unsigned long> paths;
+	unordered_map<unsigned long long, unsigned long> hashes;
+	for (unsigned long i = 0; i < fRows; i++) {
+		paths[path(i)] = i;
+		hashes[value<unsigned long long>(kHash, i)] = i;
+	}
+
+	vector<scorefeatures> results (files.size());
+	vector<int> status (files.size(), kFailed);
+	atomic<size_t> next (0);
+	auto worker = [&] () {
+		for (size_t n = next++; n < files.size(); n = next++) {
+			const char* file = files[n].c_str();
+			scorefeatures& f = results[n];
+			if (!filestat (file, f.fMTime, f.fSize)) continue;
+			unordered_map<std::string, unsigned long>::const_iterator p = paths.find (files[n]);
+			if (p != paths.end()) {
+				unsigned long row = p->second;
+				// a file modified while the index was written may have the same time: it is hashed again
+				if ((value<unsigned long long>(kMTime, row) == f.fMTime) && (value<unsigned long long>(kSize, row) == f.fSize) && (f.fMTime < fWriteTime)) {
+					get (row, f);
+					status[n] = kUnchanged;
+					continue;
+				}
+			}
+			std::string content;
+			if (!readcontent (file, content)) continue;
+			unsigned long long hash = doccache::hash (content.data(), content.size());
+			unordered_map<unsigned long long, unsigned long>::const_iterator h = hashes.find (hash);
+			if ((h != hashes.end()) && (value<unsigned long long>(kSize, h->second) == content.size())) {
+				unsigned long long mtime = f.fMTime;
+				get (h->second, f);
+				f.fPath = files[n];
+				f.fMTime = mtime;
+				status[n] = kSameContent;
+				continue;
+			}
+			f.fPath = files[n];
+			f.fHash = hash;
+			if (analyse (content, f)) status[n] = kParsed;
+		}
+	};
+	if (workers < 1) workers = 1;
+	vector<thread> threads;
+	for (int i = 1; i < workers; i++)
+		threads.push_back (thread (worker));
+	worker();
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+
+	updatestats stats;
+	memset (&stats, 0, sizeof(stats));
+	stats.fFiles = (unsigned long)files.size();
+	out.clear();
+	for (size_t i = 0; i < files.size(); i++) {
+		switch (status[i]) {
+			case kFailed:		stats.fFailed++; continue;
+			case kUnchanged:	stats.fUnchanged++; break;
+			case kSameContent:	stats.fSameContent++; break;
+			case kParsed:		stats.fParsed++; break;
+		}
+		out.push_back (results[i]);
+	}
+	return stats;
+}
+
+//______________________________________________________________________________
+static void align (ostream& out)
+{
+	static const char pad[8] = { 0 };
+	long pos = (long)out.tellp();
+	if (pos % 8) out.write (pad, 8 - (pos % 8));
+}
+
+static const std::string& field (const scorefeatures& f, int column)
+{
+	switch (column) {
+		case kPath:			return f.fPath;
+		case kTitle:		return f.fTitle;
+		case kComposer:		return f.fComposer;
+		case kVersion:		return f.fVersion;
+		case kParts:		return f.fParts;
+		case kInstruments:	return f.fInstruments;
+		case kMode:			return f.fMode;
+		default:			return f.fTime;
+	}
+}
+
+static unsigned long long longfield (const scorefeatures& f, int column)
+{
+	switch (column) {
+		case kMTime:	return f.fMTime;
+		case kSize:		return f.fSize;
+		default:		return f.fHash;
+	}
+}
+
+static int intfield (const scorefeatures& f, int column)
+{
+	switch (column) {
+		case kPartsCount:	return f.fPartsCount;
+		case kStaves:		return f.fStaves;
+		case kVoices:		return f.fVoices;
+		case kMeasures:		return f.fMeasures;
+		case kNotes:		return f.fNotes;
+		case kLowest:		return f.fLowest;
+		case kHighest:		return f.fHighest;
+		default:			return f.fFifths;
+	}
+}
+
+bool corpusindex::write (const char* file, const vector<scorefeatures>& scores)
+{
+	ofstream out (file, ios::out | ios::binary | ios::trunc);
+	if (!out.is_open()) return false;
+
+	indexheader h;
+	memcpy (h.fMagic, kMagic, 8);
+	h.fVersion = kFormatVersion;
+	h.fColumns = kColumnsCount;
+	h.fRows = scores.size();
+	out.write ((const char*)&h, sizeof(h));
+	vector<unsigned long long> offsets (kColumnsCount, 0);
+	out.write ((const char*)&offsets[0], kColumnsCount * sizeof(unsigned long long));
+
+	for (int c = 0; c < kColumnsCount; c++) {
+		align (out);
+		offsets[c] = (unsigned long long)out.tellp();
+		if (c < kStringColumns) {
+			unsigned long long offset = 0;
+			out.write ((const char*)&offset, sizeof(offset));
+			for (size_t i = 0; i < scores.size(); i++) {
+				offset += field (scores[i], c).size();
+				out.write ((const char*)&offset, sizeof(offset));
+			}
+			for (size_t i = 0; i < scores.size(); i++) {
+				const std::string& s = field (scores[i], c);
+				out.write (s.data(), s.size());
+			}
+		}
+		else if (c < kLongColumns) {
+			for (size_t i = 0; i < scores.size(); i++) {
+				unsigned long long v = longfield (scores[i], c);
+				out.write ((const char*)&v, sizeof(v));
+			}
+		}
+		else {
+			for (size_t i = 0; i < scores.size(); i++) {
+				int v = intfield (scores[i], c);
+				out.write ((const char*)&v, sizeof(v));
+			}
+		}
+	}
+	out.seekp (sizeof(indexheader));
+	out.write ((const char*)&offsets[0], kColumnsCount * sizeof(unsigned long long));
+	return out.good();
+}
+
+//______________________________________________________________________________
+static std::string escape (const std::string& s)
+{
+	std::string out;
+	for (size_t i = 0; i < s.size(); i++) {
+		unsigned char c = (unsigned char)s[i];
+		if (c == '"' || c == '\\')	{ out += '\\'; out += char(c); }
+		else if (c == '\n')			out += "\\n";
+		else if (c < 0x20)			out += ' ';
+		else out += char(c);
+	}
+	return out;
+}
+
+void corpusindex::print (ostream& out, const scorefeatures& f)
+{
+	out << "{ \"path\": \"" << escape(f.fPath) << "\""
+		<< ", \"title\": \"" << escape(f.fTitle) << "\""
+		<< ", \"composer\": \"" << escape(f.fComposer) << "\""
+		<< ", \"version\": \"" << escape(f.fVersion) << "\""
+		<< ", \"parts\": \"" << escape(f.fParts) << "\""
+		<< ", \"instruments\": \"" << escape(f.fInstruments) << "\""
+		<< ", \"parts_count\": " << f.fPartsCount
+		<< ", \"staves\": " << f.fStaves
+		<< ", \"voices\": " << f.fVoices
+		<< ", \"measures\": " << f.fMeasures
+		<< ", \"notes\": " << f.fNotes
+		<< ", \"lowest\": " << f.fLowest
+		<< ", \"highest\": " << f.fHighest
+		<< ", \"fifths\": " << f.fFifths
+		<< ", \"mode\": \"" << escape(f.fMode) << "\""
+		<< ", \"time\": \"" << escape(f.fTime) << "\""
+		<< " }";
+}
+
+}
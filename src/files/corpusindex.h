@@ -0,0 +1,156 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __corpusindex__
+#define __corpusindex__
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "exports.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief The features of a score, as stored in a corpus index.
+
+	The header fields are collected by xmlprobe from the score tree, the content features are computed
+	using partsummary, keysignvisitor, timesignvisitor and notevisitor.
+	The parts names and the instruments are separated by newlines.
+*/
+typedef struct scorefeatures {
+	std::string		fPath;
+	unsigned long long	fMTime;			///< the file modification time, in nanoseconds
+	unsigned long long	fSize;			///< the file size
+	unsigned long long	fHash;			///< the file content hash
+
+	std::string		fTitle;
+	std::string		fComposer;
+	std::string		fVersion;
+	std::string		fParts;			///< the parts names
+	std::string		fInstruments;	///< the instruments names
+
+	int		fPartsCount;
+	int		fStaves;		///< the total count of staves
+	int		fVoices;		///< the total count of voices
+	int		fMeasures;		///< the measures count of the longest part
+	int		fNotes;			///< the count of notes (rests excluded)
+	int		fLowest;		///< the lowest MIDI pitch, -1 when there is no pitched note
+	int		fHighest;		///< the highest MIDI pitch, -1 when there is no pitched note
+	int		fFifths;		///< the first key signature
+	std::string		fMode;	///< the first key mode
+	std::string		fTime;	///< the first time signature e.g. "3/4", empty when none
+} scorefeatures;
+
+//______________________________________________________________________________
+/*!
+\brief A corpus index query: the default values match any score.
+*/
+class EXP corpusquery
+{
+	public:
+		enum { kAnyKey = -100 };
+
+		std::string	fComposer;		///< a case insensitive substring of the composer
+		std::string	fTitle;			///< a case insensitive substring of the title
+		std::string	fInstrument;	///< a case insensitive substring of a part or instrument name
+		int			fFifths;		///< the first key signature, kAnyKey for any
+		std::string	fMode;			///< the first key mode
+		std::string	fTime;			///< the first time signature
+		int			fLowest;		///< the notes must be within [fLowest, fHighest]
+		int			fHighest;
+		int			fMinMeasures;	///< the measures count must be within [fMinMeasures, fMaxMeasures]
+		int			fMaxMeasures;
+
+				 corpusquery() : fFifths(kAnyKey), fLowest(0), fHighest(127), fMinMeasures(0), fMaxMeasures(0x7fffffff) {}
+		virtual ~corpusquery() {}
+};
+
+//______________________________________________________________________________
+/*!
+\brief An on-disk columnar index of a corpus of scores.
+
+	The index file stores each feature as a column: the numeric columns are
+	arrays, the string columns are an offsets array and a characters block.
+	The file is mapped in memory when opened (read in memory when mapping is not
+	available): the queries scan the columns they use only.
+
+	An index is updated incrementally: a file with unchanged path, modification
+	time and size keeps its features, a file with a changed modification time
+	but a known content hash gets the features of the same content. The other
+	files are parsed, by several workers. A file with a modification time not
+	older than the index is hashed again: it may have changed while the index
+	was written.
+	Note that the parser is not reentrant: the workers read, hash and analyse
+	the files concurrently but the parsing is serialized.
+*/
+class EXP corpusindex
+{
+	public:
+		typedef struct {
+			unsigned long	fFiles;
+			unsigned long	fUnchanged;		///< the files with unchanged path, time and size
+			unsigned long	fSameContent;	///< the changed files with a known content hash
+			unsigned long	fParsed;
+			unsigned long	fFailed;
+		} updatestats;
+
+				 corpusindex();
+		virtual ~corpusindex();
+
+		//! opens an index file
+		bool	open (const char* file);
+		void	close ();
+
+		//! gives the number of indexed scores
+		unsigned long	size () const		{ return fRows; }
+		//! gives the features of an indexed score
+		void	get (unsigned long row, scorefeatures& f) const;
+		//! gives the path of an indexed score
+		std::string		path (unsigned long row) const;
+		//! gives the indexes of the scores matching a query
+		void	query (const corpusquery& q, std::vector<unsigned long>& rows) const;
+
+		/*! computes the features of a set of files, reusing the features of the opened index
+			\param files the files to index
+			\param workers the count of workers threads
+			\param out on output, the features of the readable files, in the files order
+			\return the update statistics
+		*/
+		updatestats	update (const std::vector<std::string>& files, int workers, std::vector<scorefeatures>& out) const;
+		//! computes the features of a file, returns false when the file can't be read
+		static bool	features (const char* file, scorefeatures& f);
+		//! writes an index file
+		static bool	write (const char* file, const std::vector<scorefeatures>& scores);
+
+		//! prints the features of a score in JSON format
+		static void	print (std::ostream& out, const scorefeatures& f);
+
+	private:
+		const char*		fData;
+		unsigned long	fDataSize;
+		bool			fMapped;
+		unsigned long	fRows;
+		unsigned long long	fWriteTime;		///< the index file modification time
+		std::vector<const char*>	fColumns;
+
+		const char*		str (int column, unsigned long row, unsigned long& length) const;
+		std::string		text (int column, unsigned long row) const;
+		template <typename T> T	value (int column, unsigned long row) const		{ return ((const T*)fColumns[column])[row]; }
+};
+
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "doccache.h"
+#include "footprint.h"
+#include "readerinternals.h"
+#include "xmlreader.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// the cache entries
+//______________________________________________________________________________
+// the documents are shared by reference count (atomic) since the SXMLFile
+// reference counts are not: they are only updated with gConvertLock held
+typedef struct document {
+	SXMLFile	fFile;
+} document;
+typedef shared_ptr<document> Sdocument;
+
+// an entry is a parsed document or a conversion output
+typedef struct entry {
+	string			fKey;
+	Sdocument		fDocument;
+	string			fOutput;
+	unsigned long	fBytes;
+} entry;
+
+typedef list<entry>	entries;		// the most recently used first
+
+static mutex			gLock;
+static mutex			gConvertLock;	// nor the converters (e.g. guidonotestatus)
+static entries			gEntries;
+static unordered_map<string, entries::iterator> gIndex;
+static unsigned long	gBudget = 0;
+static unsigned long	gBytes = 0;
+static bool				gOutputs = false;
+static TCacheStats		gStats;
+
+//______________________________________________________________________________
+// a fast 64 bits hash of the content, processed by words
+unsigned long long doccache::hash (const char* data, size_t size)
+{
+	const unsigned long long m = 0x9e3779b97f4a7c15ULL;
+	unsigned long long h = size * m;
+	size_t n = size / 8;
+	for (size_t i = 0; i < n; i++, data += 8) {
+		unsigned long long w;
+		memcpy (&w, data, 8);
+		h ^= w * m;
+		h = ((h << 31) | (h >> 33)) * m;
+	}
+	unsigned long long w = 0;
+	memcpy (&w, data, size % 8);
+	h ^= w * m;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return h;
+}
+
+static string documentKey (const char* data, size_t size)
+{
+	char key[64];
+	sprintf (key, "%016llx-%lu", doccache::hash (data, size), (unsigned long)size);
+	return key;
+}
+
+static string outputKey (const string& doc, const char* name, bool generateBars, const char* file)
+{
+	stringstream key;
+	key << doc << ":" << name << ":" << generateBars << ":" << (file ? file : "");
+	return key.str();
+}
+
+//______________________________________________________________________________
+// the cache operations, called with the cache locked
+static entry* find (const string& key)
+{
+	unordered_map<string, entries::iterator>::iterator i = gIndex.find (key);
+	if (i == gIndex.end()) return 0;
+	gEntries.splice (gEntries.begin(), gEntries, i->second);
+	return &gEntries.front();
+}
+
+static void drop (entries::iterator i)
+{
+	if (i->fDocument) gStats.documents--;
+	else gStats.outputs--;
+	gBytes -= i->fBytes;
+	gIndex.erase (i->fKey);
+	gEntries.erase (i);
+}
+
+static void evict ()
+{
+	while (gBytes > gBudget)
+		drop (--gEntries.end());
+}
+
+static void insert (const string& key, Sdocument doc, const string& output, unsigned long bytes)
+{
+	if (!gBudget || (bytes > gBudget) || gIndex.count (key)) return;
+	entry e;
+	e.fKey = key;
+	e.fDocument = doc;
+	e.fOutput = output;
+	e.fBytes = bytes;
+	gEntries.push_front (e);
+	gIndex[key] = gEntries.begin();
+	if (doc) gStats.documents++;
+	else gStats.outputs++;
+	gBytes += bytes;
+	evict();
+}
+
+//______________________________________________________________________________
+// the conversion with the cache: the file content or the buffer is parsed when missing,
+// the file content is the hashed one (the file is read once)
+static xmlErr convert (const string& key, const char* file, const string* content, const char* buffer, const char* name, doccache::conversion f, bool generateBars, string& out)
+{
+	string okey = outputKey (key, name, generateBars, file);
+	Sdocument doc;
+	bool outputs;
+	{
+		lock_guard<mutex> lock (gLock);
+		outputs = gOutputs;
+		if (outputs) {
+			entry* e = find (okey);
+			if (e) {
+				gStats.outputHits++;
+				out = e->fOutput;
+				return kNoErr;
+			}
+		}
+		entry* e = find (key);
+		if (e) {
+			gStats.hits++;
+			doc = e->fDocument;
+		}
+		else gStats.misses++;
+	}
+
+	if (!doc) {
+		// the tree is not shared until it is inserted
+		doc = make_shared<document>();
+		xmlreader r;
+		doc->fFile = content ? r.readcontent (*content) : r.readbuff (buffer);
+		if (!doc->fFile) return kInvalidFile;
+		footprint fp;
+		fp.add (doc->fFile);
+		lock_guard<mutex> lock (gLock);
+		insert (key, doc, "", fp.fHeapBytes + sizeof(document) + key.size());
+	}
+
+	xmlErr err;
+	{
+		lock_guard<mutex> lock (gConvertLock);
+		err = f (doc->fFile, generateBars, out, file);
+	}
+	if ((err == kNoErr) && outputs) {
+		lock_guard<mutex> lock (gLock);
+		if (gOutputs) insert (okey, Sdocument(), out, (unsigned long)(out.size() + okey.size()));
+	}
+	return err;
+}
+
+//______________________________________________________________________________
+// doccache
+//______________________________________________________________________________
+bool doccache::enabled ()
+{
+	lock_guard<mutex> lock (gLock);
+	return gBudget != 0;
+}
+
+xmlErr doccache::convertfile (const char* file, const char* name, conversion f, bool generateBars, string& out)
+{
+	string content;
+	if (!readcontent (file, content)) return kInvalidFile;
+	return convert (documentKey (content.data(), content.size()), file, &content, 0, name, f, generateBars, out);
+}
+
+xmlErr doccache::convertbuff (const char* buffer, const char* name, conversion f, bool generateBars, string& out)
+{
+	return convert (documentKey (buffer, strlen(buffer)), 0, 0, buffer, name, f, generateBars, out);
+}
+
+//______________________________________________________________________________
+void doccache::budget (unsigned long bytes, bool outputs)
+{
+	lock_guard<mutex> lock (gLock);
+	gBudget = bytes;
+	gOutputs = outputs;
+	if (!outputs) {
+		for (entries::iterator i = gEntries.begin(); i != gEntries.end(); ) {
+			entries::iterator next = i; next++;
+			if (!i->fDocument) drop (i);
+			i = next;
+		}
+	}
+	evict();
+}
+
+void doccache::clear ()
+{
+	lock_guard<mutex> lock (gLock);
+	gEntries.clear();
+	gIndex.clear();
+	gBytes = 0;
+	memset (&gStats, 0, sizeof(gStats));
+}
+
+void doccache::stats (TCacheStats& s)
+{
+	lock_guard<mutex> lock (gLock);
+	s = gStats;
+	s.bytes = gBytes;
+	s.budget = gBudget;
+}
+
+}
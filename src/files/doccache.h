@@ -0,0 +1,65 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __doccache__
+#define __doccache__
+
+#include <string>
+
+#include "exports.h"
+#include "libmusicxml.h"
+#include "xmlfile.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\internal
+\brief The process-wide documents cache used by the conversion functions.
+
+	The parsed documents are indexed by a 64 bits hash and the length of their
+	content. The outputs are indexed by the document, the conversion name, the
+	options and the file name (that may appear in the output).
+	The memory charged for a document is its footprint.
+
+	The conversions are made to a string: the output is entirely buffered, even
+	when it is not cached. A file is read once, its content is parsed as hashed.
+
+	The lookups are thread safe. The parser and the converters are not
+	reentrant: the parsing and the conversions are serialized.
+*/
+class EXP doccache
+{
+	public:
+		//! a conversion to a string, the file name is optional
+		typedef xmlErr (*conversion) (SXMLFile& xmlfile, bool generateBars, std::string& out, const char* file);
+
+		//! the content hash used as key, not a cryptographic hash
+		static unsigned long long	hash (const char* data, size_t size);
+		//! returns true when the cache has a non null budget
+		static bool		enabled ();
+		//! converts a file, read when its content is not in the cache
+		static xmlErr	convertfile	(const char* file, const char* name, conversion f, bool generateBars, std::string& out);
+		//! converts a MusicXML string, parsed when not in the cache
+		static xmlErr	convertbuff	(const char* buffer, const char* name, conversion f, bool generateBars, std::string& out);
+
+		//! sets the cache budget in bytes (0 disables the cache) and the outputs caching
+		static void		budget (unsigned long bytes, bool outputs);
+		//! drops the cache entries and clears the statistics
+		static void		clear ();
+		static void		stats (TCacheStats& s);
+};
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "footprint.h"
+#include "xmlvisitor.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// the accounting walk
+//______________________________________________________________________________
+class footprintwalk {
+	footprint&			fFootprint;
+	set<const void*>	fShared;		// the shared objects already counted
+
+	// a string buffer is on the heap unless it is stored in the string object
+	void text (const string& s, unsigned long& length) {
+		length += (unsigned long)s.size();
+		const char* data = s.data();
+		if (!s.capacity() || ((data >= (const char*)&s) && (data < (const char*)(&s + 1))))
+			return;
+		fFootprint.fBlocks++;
+		fFootprint.fHeapBytes += (unsigned long)s.capacity() + 1;
+		fFootprint.fSlackBytes += (unsigned long)(s.capacity() - s.size());
+	}
+
+	template <typename T> void storage (const vector<T>& v) {
+		if (!v.capacity()) return;
+		fFootprint.fBlocks++;
+		fFootprint.fHeapBytes += (unsigned long)(v.capacity() * sizeof(T));
+		fFootprint.fSlackBytes += (unsigned long)((v.capacity() - v.size()) * sizeof(T));
+	}
+
+	// objects referenced more than once are counted on their first visit only
+	bool first (const smartable* obj) {
+		return (obj->refs() <= 1) || fShared.insert(obj).second;
+	}
+
+	public:
+				 footprintwalk (footprint& f) : fFootprint(f) {}
+
+		void attribute (const Sxmlattribute& attr) {
+			if (!first (attr)) return;
+			fFootprint.fAttributes++;
+			fFootprint.fBlocks++;
+			fFootprint.fHeapBytes += sizeof(xmlattribute);
+			text (attr->getName(), fFootprint.fNameBytes);
+			text (attr->getValue(), fFootprint.fValueBytes);
+		}
+
+		void element (const Sxmlelement& elt) {
+			if (!first (elt)) return;
+			fFootprint.fElements++;
+			fFootprint.fBlocks++;
+			fFootprint.fHeapBytes += sizeof(xmlelement);
+			text (elt->getName(), fFootprint.fNameBytes);
+			text (elt->getValue(), fFootprint.fValueBytes);
+			storage (elt->attributes());
+			storage (elt->elements());
+			for (vector<Sxmlattribute>::const_iterator i = elt->attributes().begin(); i != elt->attributes().end(); i++)
+				attribute (*i);
+			for (vector<Sxmlelement>::const_iterator i = elt->elements().begin(); i != elt->elements().end(); i++)
+				element (*i);
+		}
+};
+
+//______________________________________________________________________________
+// footprint
+//______________________________________________________________________________
+void footprint::clear ()
+{
+	fElements = fAttributes = 0;
+	fNameBytes = fValueBytes = fCacheBytes = 0;
+	fSlackBytes = fBlocks = fHeapBytes = 0;
+}
+
+void footprint::add (const Sxmlelement& elt)
+{
+	if (!elt) return;
+	footprintwalk walk (*this);
+	walk.element (elt);
+}
+
+void footprint::add (const SXMLFile& file)
+{
+	if (!file) return;
+	fBlocks++;
+	fHeapBytes += sizeof(TXMLFile);
+	const xmlprintcache* cache = file->printCache();
+	if (cache) {
+		for (xmlprintcache::entries::const_iterator i = cache->fEntries.begin(); i != cache->fEntries.end(); i++) {
+			fBlocks++;
+			fHeapBytes += sizeof(*i) + (unsigned long)i->second.fText.capacity() + 1;
+			fCacheBytes += (unsigned long)i->second.fText.size();
+		}
+	}
+	add (file->elements());
+}
+
+//______________________________________________________________________________
+void footprint::print (ostream& out) const
+{
+	out << "{ \"elements\": " << fElements
+		<< ", \"attributes\": " << fAttributes
+		<< ", \"name_bytes\": " << fNameBytes
+		<< ", \"value_bytes\": " << fValueBytes
+		<< ", \"cache_bytes\": " << fCacheBytes
+		<< ", \"slack_bytes\": " << fSlackBytes
+		<< ", \"blocks\": " << fBlocks
+		<< ", \"heap_bytes\": " << fHeapBytes
+		<< " }";
+}
+
+}
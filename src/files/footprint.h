@@ -0,0 +1,64 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __footprint__
+#define __footprint__
+
+#include <ostream>
+
+#include "exports.h"
+#include "xml.h"
+#include "xmlfile.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief The memory footprint of a document.
+
+	The footprint is computed by a walk of the tree: it accounts for the elements
+	and attributes objects, the heap buffers of their strings (names and values),
+	the storage of their vectors and the file print cache (see xmlvisitor). Strings stored
+	in place (small strings optimization) don't use the heap.
+	Shared elements or attributes are counted once.
+
+	The heap bytes are the requested sizes: the allocator adds a per block
+	overhead that may be estimated from the blocks count.
+*/
+class EXP footprint
+{
+	public:
+		unsigned long	fElements;
+		unsigned long	fAttributes;
+		unsigned long	fNameBytes;		///< the elements and attributes names lengths
+		unsigned long	fValueBytes;	///< the elements and attributes values lengths
+		unsigned long	fCacheBytes;	///< the lengths of the serialized text in the file print cache
+		unsigned long	fSlackBytes;	///< the allocated but unused bytes of the strings and vectors
+		unsigned long	fBlocks;		///< the heap blocks count
+		unsigned long	fHeapBytes;		///< the total heap bytes
+
+				 footprint()	{ clear(); }
+		virtual ~footprint() {}
+
+		void	clear ();
+		//! accounts for a tree
+		void	add (const Sxmlelement& elt);
+		//! accounts for a document, the xml declaration and the document type excluded
+		void	add (const SXMLFile& file);
+		//! prints the footprint in JSON format
+		void	print (std::ostream& out) const;
+};
+
+}
+
+#endif
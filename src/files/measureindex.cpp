@@ -0,0 +1,406 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <string.h>
+#include <algorithm>
+
+#include "elements.h"
+#include "measureindex.h"
+#include "xmlreader.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// source scanning utilities
+//______________________________________________________________________________
+static bool space (char c)	{ return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r'); }
+
+static bool at (const char* src, size_t len, size_t pos, const char* str)
+{
+	size_t n = strlen (str);
+	return (pos + n <= len) && !strncmp (src + pos, str, n);
+}
+
+// skips to the end of a construct, counting the lines
+static size_t skip (const char* src, size_t len, size_t pos, const char* end, int& line)
+{
+	size_t stop = pos;
+	while ((stop < len) && !at (src, len, stop, end)) stop++;
+	stop = (stop < len) ? stop + strlen(end) : len;
+	for (size_t i = pos; i < stop; i++)
+		if (src[i] == '\n') line++;
+	return stop;
+}
+
+// gives an attribute value from a start tag text
+static string attribute (const char* src, size_t pos, size_t end, const char* name)
+{
+	while (pos < end) {
+		while ((pos < end) && space(src[pos])) pos++;
+		size_t n = pos;
+		while ((n < end) && (src[n] != '=') && !space(src[n])) n++;
+		string attr (src + pos, n - pos);
+		while ((n < end) && (src[n] != '"') && (src[n] != '\'')) n++;
+		if (n >= end) break;
+		char quote = src[n++];
+		size_t v = n;
+		while ((v < end) && (src[v] != quote)) v++;
+		if (v >= end) break;
+		if (attr == name) return string (src + n, v - n);
+		pos = v + 1;
+	}
+	return "";
+}
+
+static bool tag (const char* src, size_t name, size_t n, const char* str)
+{
+	return (n - name == strlen(str)) && !strncmp (src + name, str, n - name);
+}
+
+/*
+	scans the parts and measures of a source from a position, the spans are
+	appended to a list: the parent of a top level span is -1, the other ones
+	are indexes in the list. When 'one' is true, the scan stops at the end of
+	the first element. 'context' gives the enclosing part and measure.
+*/
+static bool scan (const char* src, size_t len, size_t pos, int line, const measureindex::span& context, bool one, vector<measureindex::span>& spans)
+{
+	size_t first = spans.size();
+	vector<int> open;				// the open parts and measures
+	size_t i = pos;
+	while (i < len) {
+		char c = src[i];
+		if (c != '<') {
+			if (c == '\n') line++;
+			i++;
+			continue;
+		}
+		if (at (src, len, i, "<!--"))		{ i = skip (src, len, i, "-->", line); continue; }
+		if (at (src, len, i, "<![CDATA["))	{ i = skip (src, len, i, "]]>", line); continue; }
+		if (at (src, len, i, "<?"))			{ i = skip (src, len, i, "?>", line); continue; }
+		if (at (src, len, i, "<!"))			{ i = skip (src, len, i, ">", line); continue; }
+
+		int startline = line;
+		bool endtag = (i + 1 < len) && (src[i+1] == '/');
+		size_t name = i + (endtag ? 2 : 1);
+		size_t n = name;
+		while ((n < len) && !space(src[n]) && (src[n] != '>') && (src[n] != '/')) n++;
+		// looks for the tag end, quoted values may include '>'
+		size_t end = n;
+		char quote = 0;
+		for (; end < len; end++) {
+			char e = src[end];
+			if (e == '\n') line++;
+			if (quote) { if (e == quote) quote = 0; }
+			else if ((e == '"') || (e == '\'')) quote = e;
+			else if (e == '>') break;
+		}
+		if (end >= len) return false;
+
+		int type = 0;
+		if (tag (src, name, n, "part")) type = k_part;
+		else if (tag (src, name, n, "measure")) type = k_measure;
+		if (type) {
+			bool closed = false;
+			if (endtag) {
+				if (open.empty() || (spans[open.back()].fType != type)) return false;
+				spans[open.back()].fEnd = end + 1;
+				spans[open.back()].fEndLine = line;
+				open.pop_back();
+				closed = true;
+			}
+			else {
+				measureindex::span s;
+				s.fType = type;
+				s.fStart = i;
+				s.fEnd = end + 1;
+				s.fLine = startline;
+				s.fEndLine = line;
+				s.fParent = open.empty() ? -1 : open.back() - int(first);
+				s.fPart = context.fPart;
+				s.fMeasure = context.fMeasure;
+				s.fElement = 0;
+				for (vector<int>::const_iterator o = open.begin(); o != open.end(); o++) {
+					if (spans[*o].fType == k_part) s.fPart = spans[*o].fPart;
+					else s.fMeasure = spans[*o].fMeasure;
+				}
+				if (type == k_part) s.fPart = attribute (src, n, end, "id");
+				else s.fMeasure = attribute (src, n, end, "number");
+				spans.push_back (s);
+				if (src[end-1] != '/') open.push_back (int(spans.size()) - 1);
+				else closed = true;
+			}
+			if (one && closed && open.empty()) return true;
+		}
+		else if (one && (spans.size() == first)) return false;	// the element is expected first
+		i = end + 1;
+	}
+	return open.empty() && !one;
+}
+
+//______________________________________________________________________________
+// measureindex
+//______________________________________________________________________________
+void measureindex::clear ()
+{
+	fLength = 0;
+	fRoot = (xmlelement*)0;
+	fSpans.clear();
+	fParts.clear();
+	fMeasures.clear();
+}
+
+void measureindex::index ()
+{
+	fParts.clear();
+	fMeasures.clear();
+	for (size_t j = 0; j < fSpans.size(); j++) {
+		const span& s = fSpans[j];
+		if (s.fType == k_part) fParts.insert (make_pair (s.fPart, int(j)));
+		else fMeasures.insert (make_pair (make_pair (s.fPart, s.fMeasure), int(j)));
+	}
+}
+
+//______________________________________________________________________________
+bool measureindex::build (const char* buffer)
+{
+	clear();
+	if (!buffer) return false;
+	fLength = strlen (buffer);
+	span context;
+	if (!scan (buffer, fLength, 0, 1, context, false, fSpans)) {
+		clear();
+		return false;
+	}
+	index();
+	return true;
+}
+
+//______________________________________________________________________________
+// collects the parts and measures in the document order
+static void collect (const Sxmlelement& elt, vector<xmlelement*>& list)
+{
+	for (ctree<xmlelement>::literator i = elt->lbegin(); i != elt->lend(); i++) {
+		int type = (*i)->getType();
+		if ((type == k_part) || (type == k_measure)) {
+			list.push_back (*i);
+			collect (*i, list);
+		}
+	}
+}
+
+// binds a list of spans to the elements of a subtree, the subtree root excluded
+static bool bind (const Sxmlelement& elt, vector<measureindex::span>& spans, size_t first)
+{
+	vector<xmlelement*> elts;
+	if (elt) collect (elt, elts);
+	bool match = (elts.size() == spans.size() - first);
+	for (size_t i = 0; match && (i < elts.size()); i++)
+		match = (elts[i]->getType() == spans[first + i].fType);
+	for (size_t i = first; i < spans.size(); i++)
+		spans[i].fElement = match ? elts[i - first] : 0;
+	return match;
+}
+
+bool measureindex::bind (const Sxmlelement& root)
+{
+	bool match = MusicXML2::bind (root, fSpans, 0);
+	fRoot = match ? root : Sxmlelement();
+	return match;
+}
+
+//______________________________________________________________________________
+// gives the innermost span strictly including a range, -1 when none
+// a range reaching a span bounds may insert or remove the span, the enclosing span is then selected
+int measureindex::enclosing (size_t start, size_t end) const
+{
+	int lo = 0, hi = int(fSpans.size());		// the last span starting before the range
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (fSpans[mid].fStart < start) lo = mid + 1;
+		else hi = mid;
+	}
+	int i = lo - 1;
+	while ((i >= 0) && (fSpans[i].fEnd <= end))
+		i = fSpans[i].fParent;
+	return i;
+}
+
+// gives the next span that is not nested in a span
+int measureindex::next (int index) const
+{
+	int i = index + 1;
+	while ((i < int(fSpans.size())) && (fSpans[i].fStart < fSpans[index].fEnd)) i++;
+	return i;
+}
+
+//______________________________________________________________________________
+// a replaced span: the old span index, its nested spans end and the new spans
+typedef struct {
+	int			fIndex;
+	int			fNext;
+	vector<measureindex::span>	fSpans;
+	Sxmlelement	fElement;
+} replacement;
+
+bool measureindex::update (const char* buffer, const vector<edit>& edits, vector<int>& replaced)
+{
+	replaced.clear();
+	if (!fRoot || !buffer) return false;
+
+	// the spans to parse again: the innermost span of each edit, nested spans excluded
+	vector<int> targets;
+	size_t last = 0;
+	long delta = 0;
+	for (vector<edit>::const_iterator i = edits.begin(); i != edits.end(); i++) {
+		if ((i->fEnd < i->fStart) || (i->fStart < last) || (i->fEnd > fLength)) return false;
+		last = i->fEnd;
+		delta += long(i->fLength) - long(i->fEnd - i->fStart);
+		int n = enclosing (i->fStart, i->fEnd);
+		if (n < 0) return false;
+		targets.push_back (n);
+	}
+	sort (targets.begin(), targets.end());
+	vector<replacement> replacements;
+	for (size_t i = 0; i < targets.size(); i++) {
+		if (replacements.size() && (targets[i] < replacements.back().fNext)) continue;
+		replacement r;
+		r.fIndex = targets[i];
+		r.fNext = next (targets[i]);
+		replacements.push_back (r);
+	}
+	size_t length = size_t(long(fLength) + delta);
+
+	// rescans and parses the replaced spans in the new source, before modifying the tree
+	vector<edit>::const_iterator e = edits.begin();
+	long shift = 0;				// the bytes shift of the spans
+	int lines = 0;				// the lines shift
+	for (vector<replacement>::iterator r = replacements.begin(); r != replacements.end(); r++) {
+		const span& old = fSpans[r->fIndex];
+		while ((e != edits.end()) && (e->fEnd <= old.fStart)) {
+			shift += long(e->fLength) - long(e->fEnd - e->fStart);
+			e++;
+		}
+		long inside = 0;
+		while ((e != edits.end()) && (e->fStart < old.fEnd)) {
+			inside += long(e->fLength) - long(e->fEnd - e->fStart);
+			e++;
+		}
+		size_t start = size_t(long(old.fStart) + shift);
+		if (!scan (buffer, length, start, old.fLine + lines, old, true, r->fSpans)) return false;
+		const span& s = r->fSpans[0];
+		if ((s.fType != old.fType) || (s.fStart != start) || (s.fEnd != size_t(long(old.fEnd) + shift + inside))) return false;
+		r->fElement = parse (buffer, s);
+		if (!r->fElement || !MusicXML2::bind (r->fElement, r->fSpans, 1)) return false;
+		r->fSpans[0].fElement = r->fElement;
+		shift += inside;
+		lines += (s.fEndLine - s.fLine) - (old.fEndLine - old.fLine);
+	}
+
+	// splices the new elements into the tree
+	for (vector<replacement>::const_iterator r = replacements.begin(); r != replacements.end(); r++) {
+		const span& old = fSpans[r->fIndex];
+		Sxmlelement container = (old.fParent < 0) ? fRoot : Sxmlelement(fSpans[old.fParent].fElement);
+		for (ctree<xmlelement>::literator i = container->lbegin(); i != container->lend(); i++) {
+			if ((xmlelement*)(*i) == old.fElement) {
+				Sxmlelement previous = *i;
+				*i = r->fElement;
+				container->release (previous);
+				container->adopt (r->fElement);
+				break;
+			}
+		}
+	}
+
+	// the spans after the replaced ones are shifted, the spans indexes are remapped
+	vector<span> spans;
+	spans.reserve (fSpans.size());
+	vector<int> remap (fSpans.size(), -1);
+	bool reindex = false;
+	e = edits.begin();
+	shift = lines = 0;
+	vector<replacement>::iterator r = replacements.begin();
+	for (int i = 0; i < int(fSpans.size()); ) {
+		if ((r != replacements.end()) && (r->fIndex == i)) {
+			int base = int(spans.size());
+			int parent = (fSpans[i].fParent < 0) ? -1 : remap[fSpans[i].fParent];
+			reindex = reindex || (int(r->fSpans.size()) != r->fNext - i) || (r->fSpans[0].fPart != fSpans[i].fPart) || (r->fSpans[0].fMeasure != fSpans[i].fMeasure);
+			for (size_t n = 0; n < r->fSpans.size(); n++) {
+				span& s = r->fSpans[n];
+				s.fParent = (s.fParent < 0) ? parent : s.fParent + base;
+				if (n) reindex = true;		// the nested spans keys may change
+				spans.push_back (std::move(s));
+			}
+			replaced.push_back (base);
+			long size = long(spans[base].fEnd - spans[base].fStart) - long(fSpans[i].fEnd - fSpans[i].fStart);
+			int height = (spans[base].fEndLine - spans[base].fLine) - (fSpans[i].fEndLine - fSpans[i].fLine);
+			for (int p = parent; p >= 0; p = spans[p].fParent) {	// the enclosing spans end moves too
+				spans[p].fEnd = size_t(long(spans[p].fEnd) + size);
+				spans[p].fEndLine += height;
+			}
+			shift = long(spans[base].fEnd) - long(fSpans[i].fEnd);
+			lines += height;
+			i = r->fNext;
+			r++;
+			continue;
+		}
+		remap[i] = int(spans.size());
+		span s = std::move(fSpans[i]);
+		s.fStart = size_t(long(s.fStart) + shift);
+		s.fEnd = size_t(long(s.fEnd) + shift);
+		s.fLine += lines;
+		s.fEndLine += lines;
+		if (s.fParent >= 0) s.fParent = remap[s.fParent];
+		spans.push_back (std::move(s));
+		i++;
+	}
+	fSpans.swap (spans);
+	fLength = length;
+	if (reindex) index();
+	return true;
+}
+
+//______________________________________________________________________________
+const measureindex::span* measureindex::part (const std::string& id) const
+{
+	map<string, int>::const_iterator i = fParts.find (id);
+	return (i == fParts.end()) ? 0 : &fSpans[i->second];
+}
+
+const measureindex::span* measureindex::measure (const std::string& part, const std::string& number) const
+{
+	map<pair<string, string>, int>::const_iterator i = fMeasures.find (make_pair (part, number));
+	return (i == fMeasures.end()) ? 0 : &fSpans[i->second];
+}
+
+//______________________________________________________________________________
+Sxmlelement measureindex::parse (const char* buffer, const span& s)
+{
+	// the parser expects a document type declaration
+	string doc = "<!DOCTYPE ";
+	doc += (s.fType == k_part) ? "part" : "measure";
+	doc += " SYSTEM \"\">\n";
+	doc.append (buffer + s.fStart, s.fEnd - s.fStart);
+
+	xmlreader r;
+	SXMLFile file = r.readbuff (doc.c_str());
+	return file ? file->elements() : Sxmlelement();
+}
+
+}
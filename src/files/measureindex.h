@@ -0,0 +1,125 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __measureindex__
+#define __measureindex__
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exports.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief An index of the parts and measures of a MusicXML source.
+
+	The index gives the byte span and the line of each \b part and \b measure
+	element of a source buffer. It can be bound to the tree parsed from the same
+	source (see xmlreader::setIndex) to give a random access to the elements, and
+	a single element can be parsed again from its span, e.g. for partial reloads.
+	A bound index supports incremental updates: given the ranges changed in a new
+	source, only the innermost parts or measures including the changes are parsed
+	again and spliced into the tree, the other elements are left untouched.
+
+	Spans are computed by scanning the source: comments, processing instructions,
+	CDATA sections and the document type declaration are skipped. The lexer is not
+	used since the reader interface carries no source position: the scan keeps the
+	parser unchanged and works on any buffer given to the index.
+
+	The index doesn't keep a copy of the source: the functions using the text of
+	a span take the source as argument. An update rescans the replaced spans only,
+	the spans that follow are shifted. The bound elements are not retained by the
+	index, they are owned by the tree (the index retains the root only).
+*/
+class EXP measureindex
+{
+	public:
+		typedef struct {
+			int			fType;			///< k_part or k_measure
+			std::string	fPart;			///< the part id (the enclosing part for measures)
+			std::string	fMeasure;		///< the measure number (the enclosing measure for timewise parts)
+			size_t		fStart;			///< the element start offset in the source
+			size_t		fEnd;			///< the element end offset, past the end tag
+			int			fLine;			///< the element start line
+			int			fEndLine;		///< the line of the element end
+			int			fParent;		///< the enclosing span index, -1 at top level
+			xmlelement*	fElement;		///< the corresponding element, when the index is bound to a tree
+		} span;
+		//! an edit of the source: the bytes [fStart, fEnd) of the previous source are replaced by fLength bytes
+		typedef struct {
+			size_t		fStart;
+			size_t		fEnd;
+			size_t		fLength;
+		} edit;
+
+				 measureindex() : fLength(0) {}
+		virtual ~measureindex() {}
+
+		/*! builds the index of a source buffer
+			\param buffer the MusicXML source
+			\return false when the elements are not correctly nested
+		*/
+		bool	build (const char* buffer);
+		/*! binds the index to the tree parsed from the same source
+			\return false when the tree doesn't match the source
+		*/
+		bool	bind (const Sxmlelement& root);
+		void	clear ();
+		/*! updates the index and the bound tree from a new source
+			\param buffer the new source
+			\param edits the edits from the previous source, sorted and not overlapping, given
+			in the previous source offsets
+			\param replaced on output, the indexes of the spans that have been parsed again
+			\return false when the edits are not included in parts or measures, or when
+			the new source structure doesn't match the tree: the index and the tree are
+			then left unchanged and a complete read is required
+		*/
+		bool	update (const char* buffer, const std::vector<edit>& edits, std::vector<int>& replaced);
+
+		//! the parts and measures spans in the document order
+		const std::vector<span>&	spans () const		{ return fSpans; }
+		//! the source length
+		size_t						length () const		{ return fLength; }
+		//! the root of the bound tree, null when not bound
+		const Sxmlelement&			root () const		{ return fRoot; }
+
+		//! gives a part span, null when not found
+		const span*	part (const std::string& id) const;
+		//! gives the span of a part measure given its number, null when not found
+		const span*	measure (const std::string& part, const std::string& number) const;
+
+		//! gives the source text of a span
+		static std::string	text (const char* buffer, const span& s)	{ return std::string (buffer + s.fStart, s.fEnd - s.fStart); }
+		//! parses a span of a source again, gives a standalone element or null in case of error
+		static Sxmlelement	parse (const char* buffer, const span& s);
+
+	private:
+		size_t			fLength;
+		Sxmlelement		fRoot;		///< the tree root, when bound
+		std::vector<span>	fSpans;
+		std::map<std::string, int>							fParts;		///< parts spans indexes by id
+		std::map<std::pair<std::string, std::string>, int>	fMeasures;	///< measures spans indexes by part and number
+
+		void	index ();
+		int		enclosing (size_t start, size_t end) const;
+		int		next (int index) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,620 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <iostream>
+#include <streambuf>
+#include <string.h>
+#include <time.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "mxlfile.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// zip format constants
+//______________________________________________________________________________
+enum {
+	kLocalHeaderSig	= 0x04034b50,
+	kCentralSig		= 0x02014b50,
+	kEndSig			= 0x06054b50,
+	kLocalHeaderSize	= 30,
+	kCentralSize		= 46,
+	kEndSize			= 22,
+	kMaxComment			= 0xffff,
+	kStored			= 0,
+	kDeflated		= 8
+};
+
+static unsigned long le16 (const unsigned char* p)	{ return p[0] | (p[1] << 8); }
+static unsigned long le32 (const unsigned char* p)	{ return le16(p) | (le16(p+2) << 16); }
+
+//______________________________________________________________________________
+// the archive bytes
+//______________________________________________________________________________
+struct mxlfile::source {
+	virtual ~source() {}
+	virtual unsigned long size () = 0;
+	virtual bool	seek (unsigned long pos) = 0;
+	virtual size_t	read (void* buff, size_t size) = 0;
+};
+
+struct mxlfile::filesource : public mxlfile::source {
+	FILE*	fFile;
+			 filesource (FILE* file) : fFile(file) {}
+	virtual ~filesource()					{ fclose (fFile); }
+	virtual unsigned long size () {
+		if (fseek (fFile, 0, SEEK_END)) return 0;
+		long size = ftell (fFile);
+		return (size > 0) ? (unsigned long)size : 0;
+	}
+	virtual bool	seek (unsigned long pos)			{ return !fseek (fFile, long(pos), SEEK_SET); }
+	virtual size_t	read (void* buff, size_t size)		{ return fread (buff, 1, size, fFile); }
+};
+
+struct mxlfile::memsource : public mxlfile::source {
+	const char*		fData;
+	unsigned long	fSize;
+	unsigned long	fPos;
+			 memsource (const char* data, unsigned long size) : fData(data), fSize(size), fPos(0) {}
+	virtual unsigned long size ()						{ return fSize; }
+	virtual bool	seek (unsigned long pos) {
+		if (pos > fSize) return false;
+		fPos = pos;
+		return true;
+	}
+	virtual size_t	read (void* buff, size_t size) {
+		if (size > fSize - fPos) size = fSize - fPos;
+		memcpy (buff, fData + fPos, size);
+		fPos += (unsigned long)size;
+		return size;
+	}
+};
+
+//______________________________________________________________________________
+// the current entry state
+//______________________________________________________________________________
+struct mxlfile::inflater {
+	entry			fEntry;
+	unsigned long	fRemaining;		// the compressed bytes remaining in the archive
+	unsigned long	fCRC;
+	bool			fEnd;
+	bool			fError;			// the data are truncated, incorrect or don't match the crc
+	unsigned char	fInput[16384];
+#ifdef HAVE_ZLIB
+	z_stream		fStream;
+#endif
+};
+
+//______________________________________________________________________________
+mxlfile::mxlfile() : fSource(0), fInflater(0) {}
+mxlfile::~mxlfile()		{ close(); }
+
+//______________________________________________________________________________
+bool mxlfile::isMXL (const char* file)
+{
+	FILE* fd = fopen (file, "rb");
+	if (!fd) return false;
+	unsigned char sig[4];
+	bool zip = (fread (sig, 1, 4, fd) == 4) && (le32(sig) == kLocalHeaderSig);
+	fclose (fd);
+	return zip;
+}
+
+bool mxlfile::isMXLContent (const string& content)
+{
+	return (content.size() >= 4) && (le32((const unsigned char*)content.data()) == kLocalHeaderSig);
+}
+
+//______________________________________________________________________________
+bool mxlfile::open (const char* file)
+{
+	close();
+	FILE* fd = fopen (file, "rb");
+	if (!fd) {
+		cerr << "can't open file " << file << endl;
+		return false;
+	}
+	fSource = new filesource (fd);
+	if (!readDirectory()) {
+		cerr << file << ": incorrect or unsupported zip archive" << endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool mxlfile::openContent (const string& content)
+{
+	close();
+	fSource = new memsource (content.data(), (unsigned long)content.size());
+	if (!readDirectory()) {
+		cerr << "incorrect or unsupported zip archive" << endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void mxlfile::close ()
+{
+	closeEntry();
+	delete fSource;
+	fSource = 0;
+	fEntries.clear();
+}
+
+//______________________________________________________________________________
+// reads the central directory, located by the end of central directory record
+// which is followed by a variable length comment
+bool mxlfile::readDirectory ()
+{
+	unsigned long size = fSource->size();
+	if (size < kEndSize) return false;
+	long tail = (size < kEndSize + kMaxComment) ? long(size) : kEndSize + kMaxComment;
+	vector<unsigned char> buff (tail);
+	if (!fSource->seek (size - tail) || (fSource->read (&buff[0], tail) != size_t(tail))) return false;
+
+	long end = tail - kEndSize;
+	while ((end >= 0) && (le32(&buff[end]) != kEndSig)) end--;
+	if (end < 0) return false;
+	unsigned long count = le16 (&buff[end + 10]);
+	unsigned long dirsize = le32 (&buff[end + 12]);
+	unsigned long diroffset = le32 (&buff[end + 16]);
+
+	vector<unsigned char> dir (dirsize + 1);
+	if (!fSource->seek (diroffset) || (fSource->read (&dir[0], dirsize) != dirsize)) return false;
+	unsigned long pos = 0;
+	for (unsigned long i = 0; i < count; i++) {
+		if ((pos + kCentralSize > dirsize) || (le32(&dir[pos]) != kCentralSig)) return false;
+		const unsigned char* p = &dir[pos];
+		unsigned long namelen = le16 (p + 28);
+		unsigned long next = pos + kCentralSize + namelen + le16 (p + 30) + le16 (p + 32);
+		if (next > dirsize) return false;
+		entry e;
+		e.fMethod = int(le16 (p + 10));
+		e.fCRC = le32 (p + 16);
+		e.fCompressedSize = le32 (p + 20);
+		e.fSize = le32 (p + 24);
+		e.fOffset = le32 (p + 42);
+		e.fName.assign ((const char*)(p + kCentralSize), namelen);
+		fEntries.push_back (e);
+		pos = next;
+	}
+	return true;
+}
+
+//______________________________________________________________________________
+const mxlfile::entry* mxlfile::find (const std::string& name) const
+{
+	for (vector<entry>::const_iterator i = fEntries.begin(); i != fEntries.end(); i++)
+		if (i->fName == name) return &(*i);
+	return 0;
+}
+
+//______________________________________________________________________________
+// gives the full-path attribute of the first rootfile element
+static string rootpath (const string& container)
+{
+	size_t pos = container.find ("<rootfile");
+	while (pos != string::npos) {
+		size_t end = container.find ('>', pos);
+		size_t attr = container.find ("full-path", pos);
+		if ((attr != string::npos) && (attr < end)) {
+			size_t start = container.find_first_of ("\"'", attr);
+			if ((start == string::npos) || (start > end)) return "";
+			size_t stop = container.find (container[start], start + 1);
+			if (stop == string::npos) return "";
+			return container.substr (start + 1, stop - start - 1);
+		}
+		pos = container.find ("<rootfile", pos + 1);
+	}
+	return "";
+}
+
+const mxlfile::entry* mxlfile::rootfile ()
+{
+	const entry* container = find ("META-INF/container.xml");
+	string content;
+	if (container && extract (*container, content))
+		return find (rootpath (content));
+
+	for (vector<entry>::const_iterator i = fEntries.begin(); i != fEntries.end(); i++) {
+		const string& name = i->fName;
+		if (name.compare (0, 9, "META-INF/") && (name.size() > 4) && !name.compare (name.size() - 4, 4, ".xml"))
+			return &(*i);
+	}
+	return 0;
+}
+
+//______________________________________________________________________________
+static bool supported (int method)
+{
+#ifdef HAVE_ZLIB
+	return (method == kStored) || (method == kDeflated);
+#else
+	return method == kStored;
+#endif
+}
+
+bool mxlfile::openEntry (const entry& e)
+{
+	closeEntry();
+	if (!fSource) return false;
+	if (!supported (e.fMethod)) {
+		cerr << e.fName << ": unsupported compression method " << e.fMethod << endl;
+		return false;
+	}
+
+	unsigned char header[kLocalHeaderSize];
+	if (!fSource->seek (e.fOffset) || (fSource->read (header, kLocalHeaderSize) != kLocalHeaderSize)
+		|| (le32(header) != kLocalHeaderSig)
+		|| !fSource->seek (e.fOffset + kLocalHeaderSize + le16 (header + 26) + le16 (header + 28))) {
+		cerr << e.fName << ": incorrect zip entry" << endl;
+		return false;
+	}
+
+	fInflater = new inflater;
+	fInflater->fEntry = e;
+	fInflater->fRemaining = e.fCompressedSize;
+	fInflater->fEnd = false;
+	fInflater->fError = false;
+#ifdef HAVE_ZLIB
+	fInflater->fCRC = crc32 (0, Z_NULL, 0);
+	if (e.fMethod == kDeflated) {
+		z_stream& z = fInflater->fStream;
+		z.zalloc = Z_NULL;
+		z.zfree = Z_NULL;
+		z.opaque = Z_NULL;
+		z.next_in = Z_NULL;
+		z.avail_in = 0;
+		// zip entries are raw deflate streams, without zlib header
+		if (inflateInit2 (&z, -MAX_WBITS) != Z_OK) {
+			delete fInflater;
+			fInflater = 0;
+			return false;
+		}
+	}
+#endif
+	return true;
+}
+
+void mxlfile::closeEntry ()
+{
+	if (!fInflater) return;
+#ifdef HAVE_ZLIB
+	if (fInflater->fEntry.fMethod == kDeflated) inflateEnd (&fInflater->fStream);
+#endif
+	delete fInflater;
+	fInflater = 0;
+}
+
+//______________________________________________________________________________
+size_t mxlfile::read (char* buff, size_t size)
+{
+	if (!fInflater || fInflater->fEnd || !size) return 0;
+
+	size_t n = 0;
+	if (fInflater->fEntry.fMethod == kStored) {
+		size_t max = (size < fInflater->fRemaining) ? size : size_t(fInflater->fRemaining);
+		n = fSource->read (buff, max);
+		fInflater->fRemaining -= n;
+		if (!fInflater->fRemaining || !n) fInflater->fEnd = true;
+		if (fInflater->fRemaining && !n) {
+			cerr << fInflater->fEntry.fName << ": truncated data" << endl;
+			fInflater->fError = true;
+		}
+	}
+#ifdef HAVE_ZLIB
+	else {
+		z_stream& z = fInflater->fStream;
+		z.next_out = (Bytef*)buff;
+		z.avail_out = uInt(size);
+		while (z.avail_out && !fInflater->fEnd) {
+			int ret = Z_DATA_ERROR;
+			if (!z.avail_in) {
+				size_t max = (sizeof(fInflater->fInput) < fInflater->fRemaining) ? sizeof(fInflater->fInput) : size_t(fInflater->fRemaining);
+				size_t r = max ? fSource->read (fInflater->fInput, max) : 0;
+				fInflater->fRemaining -= r;
+				z.next_in = fInflater->fInput;
+				z.avail_in = uInt(r);
+			}
+			if (z.avail_in) ret = inflate (&z, Z_NO_FLUSH);		// no input left: the data are truncated
+			if (ret == Z_STREAM_END) fInflater->fEnd = true;
+			else if (ret != Z_OK) {
+				cerr << fInflater->fEntry.fName << ": incorrect compressed data" << endl;
+				fInflater->fEnd = true;
+				fInflater->fError = true;
+				return 0;
+			}
+		}
+		n = size - z.avail_out;
+	}
+	fInflater->fCRC = crc32 (fInflater->fCRC, (const Bytef*)buff, uInt(n));
+	if (fInflater->fEnd && (fInflater->fCRC != fInflater->fEntry.fCRC)) {
+		cerr << fInflater->fEntry.fName << ": crc error" << endl;
+		fInflater->fError = true;
+	}
+#endif
+	return n;
+}
+
+bool mxlfile::failed () const
+{
+	return fInflater && fInflater->fError;
+}
+
+//______________________________________________________________________________
+bool mxlfile::extract (const entry& e, std::string& content)
+{
+	if (!openEntry (e)) return false;
+	content.clear();
+	content.reserve (e.fSize);
+	char buff[4096];
+	size_t n;
+	while ((n = read (buff, sizeof(buff))) > 0)
+		content.append (buff, n);
+	bool done = !failed() && (content.size() == e.fSize);
+	closeEntry();
+	return done;
+}
+
+//______________________________________________________________________________
+// mxlwriter
+//______________________________________________________________________________
+static void put16 (string& s, unsigned long v)	{ s += char(v & 0xff); s += char((v >> 8) & 0xff); }
+static void put32 (string& s, unsigned long v)	{ put16 (s, v & 0xffff); put16 (s, (v >> 16) & 0xffff); }
+
+static const char* kMimeType = "application/vnd.recordare.musicxml";
+
+//______________________________________________________________________________
+mxlwriter::mxlwriter(int level) : fLevel(kDefaultCompression), fFile(0), fTime(0)
+{
+	setLevel (level);
+}
+
+bool mxlwriter::setLevel (int level)
+{
+	if (!validLevel (level)) {
+		cerr << "mxlwriter: incorrect compression level " << level << endl;
+		return false;
+	}
+	fLevel = level;
+	return true;
+}
+
+#ifdef HAVE_ZLIB
+//______________________________________________________________________________
+// an output stream buffer that deflates its content into the archive
+//______________________________________________________________________________
+class mxlwriter::deflatebuf : public streambuf
+{
+	FILE*			fFile;
+	mxlfile::entry&	fEntry;
+	z_stream		fStream;
+	bool			fOK;
+	char			fIn[16384];
+	unsigned char	fOut[16384];
+
+	bool deflate (int flush) {
+		z_stream& z = fStream;
+		size_t n = pptr() - pbase();
+		fEntry.fCRC = crc32 (fEntry.fCRC, (const Bytef*)pbase(), uInt(n));
+		fEntry.fSize += n;
+		z.next_in = (Bytef*)pbase();
+		z.avail_in = uInt(n);
+		int ret;
+		do {
+			z.next_out = fOut;
+			z.avail_out = sizeof(fOut);
+			ret = ::deflate (&z, flush);
+			if (ret == Z_STREAM_ERROR) return false;
+			size_t out = sizeof(fOut) - z.avail_out;
+			if (fwrite (fOut, 1, out, fFile) != out) return false;
+			fEntry.fCompressedSize += out;
+		} while (!z.avail_out || ((flush == Z_FINISH) && (ret != Z_STREAM_END)));
+		setp (fIn, fIn + sizeof(fIn));
+		return true;
+	}
+
+	protected:
+		virtual int overflow (int c) {
+			if (!fOK || !(fOK = deflate (Z_NO_FLUSH))) return traits_type::eof();
+			if (traits_type::eq_int_type (c, traits_type::eof())) return traits_type::not_eof (c);
+			*pptr() = traits_type::to_char_type (c);
+			pbump (1);
+			return c;
+		}
+
+	public:
+				 deflatebuf (FILE* fd, mxlfile::entry& e, int level) : fFile(fd), fEntry(e) {
+					fStream.zalloc = Z_NULL;
+					fStream.zfree = Z_NULL;
+					fStream.opaque = Z_NULL;
+					// zip entries are raw deflate streams, without zlib header
+					fOK = deflateInit2 (&fStream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+					setp (fIn, fIn + sizeof(fIn));
+				 }
+		virtual ~deflatebuf()	{ deflateEnd (&fStream); }
+
+		//! flushes the remaining data and terminates the deflate stream
+		bool	finish ()	{ return fOK = fOK && deflate (Z_FINISH); }
+};
+#endif
+
+//______________________________________________________________________________
+// the current date and time in ms-dos format
+static unsigned long dostime ()
+{
+	time_t t = time (0);
+	struct tm* d = localtime (&t);
+	if (!d || (d->tm_year < 80)) return 0x210000;		// 1980-01-01
+	unsigned long date = ((d->tm_year - 80) << 9) | ((d->tm_mon + 1) << 5) | d->tm_mday;
+	unsigned long tm = (d->tm_hour << 11) | (d->tm_min << 5) | (d->tm_sec / 2);
+	return (date << 16) | tm;
+}
+
+//______________________________________________________________________________
+// writes a local header, the crc and sizes are written by endEntry
+bool mxlwriter::startEntry (mxlfile::entry& e)
+{
+	e.fCRC = 0;
+	e.fCompressedSize = 0;
+	e.fSize = 0;
+	e.fOffset = (unsigned long)ftell (fFile);
+	string header;
+	put32 (header, kLocalHeaderSig);
+	put16 (header, 20);					// version needed to extract
+	put16 (header, 0);					// flags
+	put16 (header, e.fMethod);
+	put32 (header, fTime);
+	put32 (header, 0);					// crc
+	put32 (header, 0);					// compressed size
+	put32 (header, 0);					// uncompressed size
+	put16 (header, e.fName.size());
+	put16 (header, 0);					// extra field length
+	header += e.fName;
+	return fwrite (header.data(), 1, header.size(), fFile) == header.size();
+}
+
+bool mxlwriter::endEntry (mxlfile::entry& e)
+{
+	string sizes;
+	put32 (sizes, e.fCRC);
+	put32 (sizes, e.fCompressedSize);
+	put32 (sizes, e.fSize);
+	if (fseek (fFile, long(e.fOffset + 14), SEEK_SET)) return false;
+	if (fwrite (sizes.data(), 1, sizes.size(), fFile) != sizes.size()) return false;
+	if (fseek (fFile, 0, SEEK_END)) return false;
+	fEntries.push_back (e);
+	return true;
+}
+
+//______________________________________________________________________________
+bool mxlwriter::writeDirectory ()
+{
+	string dir;
+	for (vector<mxlfile::entry>::const_iterator i = fEntries.begin(); i != fEntries.end(); i++) {
+		put32 (dir, kCentralSig);
+		put16 (dir, 20);				// version made by
+		put16 (dir, 20);				// version needed to extract
+		put16 (dir, 0);					// flags
+		put16 (dir, i->fMethod);
+		put32 (dir, fTime);
+		put32 (dir, i->fCRC);
+		put32 (dir, i->fCompressedSize);
+		put32 (dir, i->fSize);
+		put16 (dir, i->fName.size());
+		put16 (dir, 0);					// extra field length
+		put16 (dir, 0);					// comment length
+		put16 (dir, 0);					// disk number
+		put16 (dir, 0);					// internal attributes
+		put32 (dir, 0);					// external attributes
+		put32 (dir, i->fOffset);
+		dir += i->fName;
+	}
+	unsigned long offset = (unsigned long)ftell (fFile);
+	unsigned long size = dir.size();
+	put32 (dir, kEndSig);
+	put16 (dir, 0);						// disk number
+	put16 (dir, 0);						// central directory disk
+	put16 (dir, fEntries.size());
+	put16 (dir, fEntries.size());
+	put32 (dir, size);
+	put32 (dir, offset);
+	put16 (dir, 0);						// comment length
+	return fwrite (dir.data(), 1, dir.size(), fFile) == dir.size();
+}
+
+#ifdef HAVE_ZLIB
+//______________________________________________________________________________
+bool mxlwriter::write (const char* name, const string& content, int method)
+{
+	mxlfile::entry e;
+	e.fName = name;
+	e.fMethod = method;
+	if (!startEntry (e)) return false;
+	if (method == kStored) {
+		e.fCRC = crc32 (0, (const Bytef*)content.data(), uInt(content.size()));
+		e.fSize = e.fCompressedSize = content.size();
+		if (fwrite (content.data(), 1, content.size(), fFile) != content.size()) return false;
+	}
+	else {
+		deflatebuf buf (fFile, e, fLevel);
+		buf.sputn (content.data(), content.size());
+		if (!buf.finish()) return false;
+	}
+	return endEntry (e);
+}
+
+//______________________________________________________________________________
+bool mxlwriter::write (const SXMLFile& file, const char* path, const char* name)
+{
+	if (!file) return false;
+	fFile = fopen (path, "wb");
+	if (!fFile) {
+		cerr << "can't open file " << path << endl;
+		return false;
+	}
+	fEntries.clear();
+	fTime = dostime();
+
+	string container = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<container>\n    <rootfiles>\n        <rootfile full-path=\"";
+	container += name;
+	container += "\" media-type=\"application/vnd.recordare.musicxml+xml\"/>\n    </rootfiles>\n</container>\n";
+
+	// the mimetype is the first entry and is not compressed
+	bool ok = write ("mimetype", kMimeType, kStored) && write ("META-INF/container.xml", container, kDeflated);
+	if (ok) {
+		mxlfile::entry e;
+		e.fName = name;
+		e.fMethod = kDeflated;
+		ok = startEntry (e);
+		if (ok) {
+			deflatebuf buf (fFile, e, fLevel);
+			ostream out (&buf);
+			file->print (out);
+			ok = buf.finish() && endEntry (e);
+		}
+	}
+	ok = ok && writeDirectory();
+	if (fclose (fFile)) ok = false;
+	fFile = 0;
+	if (!ok) {
+		cerr << path << ": write error" << endl;
+		remove (path);
+	}
+	return ok;
+}
+
+#else
+//______________________________________________________________________________
+bool mxlwriter::write (const char*, const string&, int)	{ return false; }
+
+bool mxlwriter::write (const SXMLFile& file, const char* path, const char* name)
+{
+	cerr << "can't write " << path << ": compressed MusicXML files require zlib" << endl;
+	return false;
+}
+#endif
+
+}
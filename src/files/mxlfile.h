@@ -0,0 +1,152 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __mxlfile__
+#define __mxlfile__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "exports.h"
+#include "xmlfile.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief A compressed MusicXML (.mxl) file reader.
+
+	A .mxl file is a zip archive: the score entry is declared by the \b rootfile
+	element of the META-INF/container.xml entry. The entries are read from the
+	archive central directory, and an entry content is inflated on demand by
+	chunks: the archive is never extracted to disk nor held in memory.
+	An archive already in memory is read in place.
+
+	Deflated entries require zlib (the library is compiled with HAVE_ZLIB), stored
+	entries are always supported.
+*/
+class EXP mxlfile
+{
+	public:
+		typedef struct {
+			std::string		fName;
+			int				fMethod;			///< the compression method: 0 (stored) or 8 (deflated)
+			unsigned long	fCRC;
+			unsigned long	fCompressedSize;
+			unsigned long	fSize;
+			unsigned long	fOffset;			///< the entry local header offset
+		} entry;
+
+				 mxlfile();
+		virtual ~mxlfile();
+
+		//! checks for a zip archive signature
+		static bool	isMXL (const char* file);
+		//! checks for a zip archive signature at the beginning of a content
+		static bool	isMXLContent (const std::string& content);
+
+		//! opens an archive and reads its entries list
+		bool	open (const char* file);
+		/*! opens an archive read in memory
+			\param content the archive content, read in place: it must be kept unchanged until the archive is closed
+		*/
+		bool	openContent (const std::string& content);
+		void	close ();
+
+		const std::vector<entry>&	entries () const		{ return fEntries; }
+		//! gives an entry by name, null when not found
+		const entry*	find (const std::string& name) const;
+		/*! gives the score entry declared by META-INF/container.xml
+			\return the first rootfile entry or, when there is no container, the first .xml
+			entry outside META-INF, null when not found
+		*/
+		const entry*	rootfile ();
+
+		//! starts reading an entry content
+		bool	openEntry (const entry& e);
+		/*! reads the next bytes of the current entry content
+			\return the count of bytes read, 0 at the end of the entry or in case of error
+		*/
+		size_t	read (char* buff, size_t size);
+		//! checks the current entry data: true when they are truncated, incorrect or don't match the entry crc
+		bool	failed () const;
+		//! reads a whole entry content, fails when the data are not correct
+		bool	extract (const entry& e, std::string& content);
+
+	private:
+		struct source;
+		struct filesource;
+		struct memsource;
+		struct inflater;
+
+		source*				fSource;		///< the archive bytes: a file or a memory span
+		std::vector<entry>	fEntries;
+		inflater*			fInflater;		///< the current entry state
+
+		bool	readDirectory ();
+		void	closeEntry ();
+};
+
+//______________________________________________________________________________
+/*!
+\brief A compressed MusicXML (.mxl) file writer.
+
+	The archive includes a \b mimetype entry, the META-INF/container.xml entry and
+	the score entry. The score is deflated while it is printed: the serialized
+	text is never held in memory.
+
+	The writer requires zlib (the library is compiled with HAVE_ZLIB).
+*/
+class EXP mxlwriter
+{
+	public:
+		enum { kDefaultCompression = -1, kNoCompression = 0, kBestSpeed = 1, kBestCompression = 9 };
+
+		//! the compression level ranges from 0 (no compression) to 9, kDefaultCompression selects the zlib default
+				 mxlwriter(int level = kDefaultCompression);
+		virtual ~mxlwriter() {}
+
+		//! checks a compression level
+		static bool	validLevel (int level)	{ return (level == kDefaultCompression) || ((level >= kNoCompression) && (level <= kBestCompression)); }
+		/*! sets the compression level
+			\return false when the level is out of range, the level is then unchanged
+		*/
+		bool	setLevel (int level);
+		int		getLevel () const			{ return fLevel; }
+
+		/*! writes a file as a compressed MusicXML file
+			\param file the file to write
+			\param path the output .mxl file path
+			\param name the score entry name in the archive
+			\return false in case of error, the partially written file is then removed
+		*/
+		bool	write (const SXMLFile& file, const char* path, const char* name = "score.xml");
+
+	private:
+		class deflatebuf;
+
+		int				fLevel;
+		FILE*			fFile;
+		unsigned long	fTime;		///< the entries modification date and time in ms-dos format
+		std::vector<mxlfile::entry>	fEntries;
+
+		bool	write (const char* name, const std::string& content, int method);
+		bool	startEntry (mxlfile::entry& e);
+		bool	endEntry (mxlfile::entry& e);
+		bool	writeDirectory ();
+};
+
+}
+
+#endif
@@ -0,0 +1,374 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+#include "doccache.h"
+#include "ngramindex.h"
+#include "notevisitor.h"
+#include "xml_tree_browser.h"
+#include "xmlreader.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// the melodies visitor: collects the melody of each voice of each part
+//______________________________________________________________________________
+typedef struct melody {
+	vector<ngramindex::note>	fNotes;
+	vector<unsigned int>		fMeasures;		// the measure of each note
+	ngramindex::note			fEvent;			// the current note or chord, reduced to its highest note
+	unsigned int				fEventMeasure;
+	bool						fTied;			// the highest note of the current event ends a tie
+	bool						fPending;		// the current event is not yet in fNotes
+} melody;
+typedef map<int, melody>	voices;				// the melodies of a part, indexed by voice
+
+class melodyvisitor :
+	public notevisitor,
+	public visitor<S_part>,
+	public visitor<S_measure>
+{
+	unsigned int	fMeasure;
+	voices			fVoices;
+
+	static void flush (melody& m);
+
+	protected:
+		void visitStart	( S_part& elt)		{ fMeasure = 0; fVoices.clear(); }
+		void visitEnd	( S_part& elt);
+		void visitStart	( S_measure& elt)	{ fMeasure++; }
+		void visitEnd	( S_note& elt);
+
+	public:
+		vector<voices>	fParts;
+
+				 melodyvisitor() : fMeasure(0) {}
+		virtual ~melodyvisitor() {}
+};
+
+// a chord is complete when the next event starts: it is then reduced to its
+// highest note, which is merged with the previous note when it ends a tie
+// with the same pitch
+void melodyvisitor::flush (melody& m)
+{
+	if (!m.fPending) return;
+	m.fPending = false;
+	if (m.fTied && m.fNotes.size() && (m.fNotes.back().fPitch == m.fEvent.fPitch)) {
+		m.fNotes.back().fDuration += m.fEvent.fDuration;
+		return;
+	}
+	m.fNotes.push_back (m.fEvent);
+	m.fMeasures.push_back (m.fEventMeasure);
+}
+
+void melodyvisitor::visitEnd ( S_part& elt )
+{
+	for (voices::iterator i = fVoices.begin(); i != fVoices.end(); i++)
+		flush (i->second);
+	fParts.push_back (fVoices);
+}
+
+void melodyvisitor::visitEnd ( S_note& elt )
+{
+	notevisitor::visitEnd (elt);
+	if ((getType() != kPitched) || isGrace() || isCue()) return;
+
+	melody& m = fVoices[getVoice()];
+	float pitch = getMidiKey();
+	bool tied = (getTie() & StartStop::stop) != 0;
+	if (inChord() && m.fPending) {
+		if (pitch > m.fEvent.fPitch) {
+			m.fEvent.fPitch = pitch;
+			m.fTied = tied;
+		}
+		else if (pitch == m.fEvent.fPitch) m.fTied = m.fTied || tied;
+		return;
+	}
+	flush (m);
+	ngramindex::note n = { pitch, getDuration() };
+	m.fEvent = n;
+	m.fEventMeasure = fMeasure;
+	m.fTied = tied;
+	m.fPending = true;
+}
+
+//______________________________________________________________________________
+// ngramindex
+//______________________________________________________________________________
+static const char*	kMagic = "MXLNGRAM";
+enum { kFormatVersion = 1 };
+
+ngramindex::ngramindex(int n) : fLength(n < 1 ? 1 : n) {}
+
+static long gcd (long a, long b)
+{
+	while (b) { long t = a % b; a = b; b = t; }
+	return a;
+}
+
+// a step is the interval and the reduced durations ratio (0/0 when unknown)
+unsigned long long ngramindex::key (const vector<note>& melody, size_t first, int length, bool rhythm)
+{
+	vector<int> steps;
+	steps.push_back (rhythm ? 1 : 0);
+	for (size_t i = first; i < first + length; i++) {
+		const note& a = melody[i];
+		const note& b = melody[i+1];
+		steps.push_back ((int)floor (b.fPitch - a.fPitch + 0.5f));
+		if (rhythm) {
+			long g = ((a.fDuration > 0) && (b.fDuration > 0)) ? gcd (a.fDuration, b.fDuration) : 0;
+			steps.push_back (g ? int(b.fDuration / g) : 0);
+			steps.push_back (g ? int(a.fDuration / g) : 0);
+		}
+	}
+	return doccache::hash ((const char*)&steps[0], steps.size() * sizeof(int));
+}
+
+//______________________________________________________________________________
+bool ngramindex::add (const char* file)
+{
+	xmlreader r;
+	SXMLFile xml = r.read (file);
+	if (!xml || !xml->elements()) return false;
+	add (xml->elements(), file);
+	return true;
+}
+
+void ngramindex::add (const Sxmlelement& score, const string& name)
+{
+	thaw();
+	unsigned int index = (unsigned int)fScores.size();
+	fScores.push_back (name);
+
+	melodyvisitor v;
+	xml_tree_browser browser (&v);
+	browser.browse (*score);
+	for (size_t part = 0; part < v.fParts.size(); part++) {
+		for (voices::const_iterator i = v.fParts[part].begin(); i != v.fParts[part].end(); i++) {
+			const melody& m = i->second;
+			for (size_t n = 0; n + fLength < m.fNotes.size(); n++) {
+				posting p = { index, (unsigned short)part, (unsigned short)i->first, (unsigned int)n, m.fMeasures[n] };
+				fGrams[key (m.fNotes, n, fLength, false)].push_back (p);
+				fGrams[key (m.fNotes, n, fLength, true)].push_back (p);
+			}
+		}
+	}
+}
+
+//______________________________________________________________________________
+void ngramindex::freeze ()
+{
+	if (fGrams.empty()) return;
+	fKeys.clear();
+	for (grams::const_iterator i = fGrams.begin(); i != fGrams.end(); i++)
+		fKeys.push_back (i->first);
+	sort (fKeys.begin(), fKeys.end());
+	fOffsets.clear();
+	fPostings.clear();
+	for (size_t i = 0; i < fKeys.size(); i++) {
+		fOffsets.push_back ((unsigned int)fPostings.size());
+		const vector<posting>& list = fGrams[fKeys[i]];
+		fPostings.insert (fPostings.end(), list.begin(), list.end());
+	}
+	fOffsets.push_back ((unsigned int)fPostings.size());
+	fGrams.clear();
+}
+
+// restores the building state
+void ngramindex::thaw ()
+{
+	for (size_t i = 0; i < fKeys.size(); i++)
+		fGrams[fKeys[i]].assign (fPostings.begin() + fOffsets[i], fPostings.begin() + fOffsets[i+1]);
+	fKeys.clear();
+	fOffsets.clear();
+	fPostings.clear();
+}
+
+unsigned int ngramindex::find (unsigned long long key, const posting*& postings) const
+{
+	if (!fGrams.empty()) {
+		grams::const_iterator i = fGrams.find (key);
+		if (i == fGrams.end()) return 0;
+		postings = &i->second[0];
+		return (unsigned int)i->second.size();
+	}
+	vector<unsigned long long>::const_iterator i = lower_bound (fKeys.begin(), fKeys.end(), key);
+	if ((i == fKeys.end()) || (*i != key)) return 0;
+	size_t n = i - fKeys.begin();
+	postings = &fPostings[fOffsets[n]];
+	return fOffsets[n+1] - fOffsets[n];
+}
+
+//______________________________________________________________________________
+// the postings of an n-gram are sorted by score, part, voice and position
+static bool before (const ngramindex::posting& a, const ngramindex::posting& b)
+{
+	if (a.fScore != b.fScore) return a.fScore < b.fScore;
+	if (a.fPart != b.fPart) return a.fPart < b.fPart;
+	if (a.fVoice != b.fVoice) return a.fVoice < b.fVoice;
+	return a.fPosition < b.fPosition;
+}
+
+static const ngramindex::posting* locate (const ngramindex::posting* list, unsigned int size, const ngramindex::posting& p)
+{
+	const ngramindex::posting* end = list + size;
+	const ngramindex::posting* i = lower_bound (list, end, p, before);
+	return ((i != end) && !before (p, *i)) ? i : 0;
+}
+
+// the rarest n-gram gives the candidates, which are checked against the other posting lists
+bool ngramindex::query (const vector<note>& motif, bool rhythm, vector<posting>& matches) const
+{
+	matches.clear();
+	if (motif.size() < size_t(fLength + 1)) return false;
+	for (size_t i = 0; rhythm && (i < motif.size()); i++)
+		if (motif[i].fDuration <= 0) return false;
+
+	size_t count = motif.size() - fLength;
+	vector<const posting*> lists (count);
+	vector<unsigned int> sizes (count);
+	size_t rarest = 0;
+	for (size_t i = 0; i < count; i++) {
+		sizes[i] = find (key (motif, i, fLength, rhythm), lists[i]);
+		if (!sizes[i]) return true;
+		if (sizes[i] < sizes[rarest]) rarest = i;
+	}
+
+	for (unsigned int n = 0; n < sizes[rarest]; n++) {
+		posting p = lists[rarest][n];
+		if (p.fPosition < rarest) continue;
+		p.fPosition -= (unsigned int)rarest;
+		const posting* first = (rarest == 0) ? &lists[0][n] : 0;
+		bool found = true;
+		for (size_t i = 0; found && (i < count); i++) {
+			if (i == rarest) continue;
+			posting q = p;
+			q.fPosition += (unsigned int)i;
+			const posting* match = locate (lists[i], sizes[i], q);
+			if (!match) found = false;
+			else if (i == 0) first = match;
+		}
+		if (found) matches.push_back (*first);
+	}
+	return true;
+}
+
+//______________________________________________________________________________
+bool ngramindex::write (const char* file)
+{
+	freeze();
+	ofstream out (file, ios::out | ios::binary | ios::trunc);
+	if (!out.is_open()) return false;
+	unsigned int header[2] = { kFormatVersion, (unsigned int)fLength };
+	out.write (kMagic, 8);
+	out.write ((const char*)header, sizeof(header));
+
+	unsigned long long n = fScores.size();
+	out.write ((const char*)&n, sizeof(n));
+	for (size_t i = 0; i < fScores.size(); i++) {
+		unsigned int length = (unsigned int)fScores[i].size();
+		out.write ((const char*)&length, sizeof(length));
+		out.write (fScores[i].data(), length);
+	}
+	n = fKeys.size();
+	out.write ((const char*)&n, sizeof(n));
+	if (n) {
+		out.write ((const char*)&fKeys[0], n * sizeof(unsigned long long));
+		out.write ((const char*)&fOffsets[0], (n + 1) * sizeof(unsigned int));
+		out.write ((const char*)&fPostings[0], fPostings.size() * sizeof(posting));
+	}
+	return out.good();
+}
+
+// the keys must be sorted, the offsets must start at 0, be increasing and the
+// postings must fit the remaining bytes of the file (read is the bytes already read)
+bool ngramindex::consistent (unsigned long long read, unsigned long long size) const
+{
+	size_t n = fKeys.size();
+	if (fOffsets[0] != 0) return false;
+	for (size_t i = 0; i < n; i++) {
+		if ((i > 0) && (fKeys[i-1] >= fKeys[i])) return false;
+		if (fOffsets[i] > fOffsets[i+1]) return false;
+	}
+	return (unsigned long long)fOffsets[n] * sizeof(posting) == size - read;
+}
+
+bool ngramindex::read (const char* file)
+{
+	ifstream in (file, ios::in | ios::binary);
+	if (!in.is_open()) return false;
+	char magic[8];
+	unsigned int header[2];
+	in.read (magic, 8);
+	in.read ((char*)header, sizeof(header));
+	if (!in || strncmp (magic, kMagic, 8) || (header[0] != kFormatVersion) || (header[1] < 1)) return false;
+
+	fLength = header[1];
+	fScores.clear();
+	fGrams.clear();
+	fKeys.clear();
+	fOffsets.clear();
+	fPostings.clear();
+	unsigned long long n = 0;
+	in.read ((char*)&n, sizeof(n));
+	for (unsigned long long i = 0; in && (i < n); i++) {
+		unsigned int length = 0;
+		in.read ((char*)&length, sizeof(length));
+		string name (length, ' ');
+		if (length) in.read (&name[0], length);
+		fScores.push_back (name);
+	}
+	in.read ((char*)&n, sizeof(n));
+	if (in && n) {
+		// the sizes are checked against the file size before allocating
+		streamoff pos = in.tellg();
+		in.seekg (0, ios::end);
+		unsigned long long remain = (unsigned long long)(in.tellg() - pos);
+		in.seekg (pos);
+		if (n * (sizeof(unsigned long long) + sizeof(unsigned int)) > remain) in.setstate (ios::failbit);
+		else {
+			fKeys.resize (n);
+			fOffsets.resize (n + 1);
+			in.read ((char*)&fKeys[0], n * sizeof(unsigned long long));
+			in.read ((char*)&fOffsets[0], (n + 1) * sizeof(unsigned int));
+		}
+		if (in && !consistent ((unsigned long long)(in.tellg() - pos), remain)) in.setstate (ios::failbit);
+		if (in) {
+			fPostings.resize (fOffsets[n]);
+			if (fOffsets[n]) in.read ((char*)&fPostings[0], fPostings.size() * sizeof(posting));
+		}
+		for (size_t i = 0; in && (i < fPostings.size()); i++)
+			if (fPostings[i].fScore >= fScores.size()) in.setstate (ios::failbit);
+	}
+	if (!in) {
+		fScores.clear();
+		fKeys.clear();
+		fOffsets.clear();
+		fPostings.clear();
+		return false;
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __ngramindex__
+#define __ngramindex__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exports.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief An inverted index of the melodic n-grams of a set of scores.
+
+	Each voice of each part is reduced to a melody: the notes are taken in the
+	voice order, the rests and grace notes are ignored, a chord is reduced to its
+	highest note and tied notes are merged. A melody is a sequence of steps: the
+	interval in semitones and the durations ratio between successive notes, which
+	makes the index independent of the transposition and of the tempo.
+
+	The n-grams of n successive steps (n + 1 notes) are hashed, with and without
+	the rhythm, and each n-gram has a posting list of its occurrences. A query
+	intersects the posting lists of the n-grams of a motif, taking their relative
+	positions into account.
+
+	The index is built using add(). Freezing the index sorts the n-grams and stores
+	the posting lists contiguously: it is frozen when written, and the queries are
+	faster on a frozen index.
+*/
+class EXP ngramindex
+{
+	public:
+		//! an n-gram occurrence, or a query match (the first note of the motif)
+		typedef struct {
+			unsigned int	fScore;			///< the score index
+			unsigned short	fPart;			///< the part index, in the score order
+			unsigned short	fVoice;			///< the voice number
+			unsigned int	fPosition;		///< the note index in the voice melody
+			unsigned int	fMeasure;		///< the measure index in the part, starting at 1
+		} posting;
+		//! a motif note, the duration unit doesn't matter (only ratios are used)
+		typedef struct {
+			float	fPitch;					///< the MIDI pitch
+			long	fDuration;				///< 0 when the rhythm is not used, positive otherwise
+		} note;
+
+				 ngramindex(int n = 4);
+		virtual ~ngramindex() {}
+
+		//! gives the n-grams length (in steps)
+		int			length () const			{ return fLength; }
+		//! gives the number of indexed scores
+		unsigned long	scores () const		{ return (unsigned long)fScores.size(); }
+		const std::string&	score (unsigned long index) const	{ return fScores[index]; }
+
+		//! reads and indexes a file, returns false when the file can't be read
+		bool	add (const char* file);
+		//! indexes a score tree under a given name
+		void	add (const Sxmlelement& score, const std::string& name);
+		//! sorts the n-grams and packs the posting lists
+		void	freeze ();
+
+		bool	write (const char* file);
+		//! reads an index, returns false when the file can't be read or is not a consistent index
+		bool	read (const char* file);
+
+		/*! searches a motif
+			\param motif the motif notes, at least length() + 1 notes
+			\param rhythm a boolean to match the durations ratios too
+			\param matches on output, the motif occurrences
+			\return false when the motif is too short, or when the rhythm is used and a note has no duration
+		*/
+		bool	query (const std::vector<note>& motif, bool rhythm, std::vector<posting>& matches) const;
+
+	private:
+		typedef std::unordered_map<unsigned long long, std::vector<posting> >	grams;
+
+		int							fLength;
+		std::vector<std::string>	fScores;
+		grams						fGrams;			// the n-grams while building
+		std::vector<unsigned long long>	fKeys;		// the sorted n-grams when frozen
+		std::vector<unsigned int>	fOffsets;		// the postings of fKeys[i] are in [fOffsets[i], fOffsets[i+1][
+		std::vector<posting>		fPostings;
+
+		void	thaw ();
+		//! checks the frozen index read from a file
+		bool	consistent (unsigned long long read, unsigned long long size) const;
+		//! gives the postings of an n-gram, returns the postings count
+		unsigned int	find (unsigned long long key, const posting*& postings) const;
+		//! the n-gram key of the steps starting at a given note
+		static unsigned long long	key (const std::vector<note>& melody, size_t first, int length, bool rhythm);
+};
+
+}
+
+#endif
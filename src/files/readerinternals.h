@@ -0,0 +1,50 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __readerinternals__
+#define __readerinternals__
+
+#include <stdio.h>
+#include <mutex>
+#include <string>
+
+#include "reader.h"
+
+/*
+	The parser interface shared by the library readers (xmlreader, xmlprobe)
+	and the files utilities shared by the caches and indexes.
+	This is an internal header: it is not part of the library API.
+*/
+namespace MusicXML2
+{
+
+// the parser entry points, defined by the parser (see parser/xml.y)
+extern "C" {
+bool readfile   (const char * file, reader * r);
+bool readstream (FILE * file, reader * r);
+bool readbuffer (const char * buffer, reader * r);
+typedef size_t (*lexsource) (void * data, char * buf, size_t size);
+bool readsource (lexsource source, void * data, reader * r);
+}
+
+//! the parser lock: the parser is not reentrant, a read may call another read
+std::recursive_mutex& parserlock ();
+
+//! a lexsource reading the current entry of an mxlfile (data is the mxlfile)
+size_t mxlsource (void * data, char * buf, size_t size);
+
+//! reads a whole file content, returns false when the file can't be read
+bool readcontent (const char* file, std::string& content);
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 */
 
 #include <iostream>
+#include "profiler.h"
 #include "xmlfile.h"
 #include "xmlvisitor.h"
 #include "tree_browser.h"
@@ -22,6 +23,7 @@ namespace MusicXML2
 
 //______________________________________________________________________________
 SXMLFile TXMLFile::create ()  { TXMLFile* o = new TXMLFile; assert(o!=0); return o; }
+TXMLFile::~TXMLFile()			{ delete fXMLDecl; delete fDocType; delete fCache; }
 
 //______________________________________________________________________________
 TDocType::TDocType (const string start) : fStartElement(start), fPublic(true) 
@@ -54,13 +56,14 @@ void TXMLDecl::print (ostream& s)
 }
 
 //______________________________________________________________________________
-void TXMLFile::print (ostream& stream) 
+void TXMLFile::print (ostream& stream, bool cache) 
 {
+	PROFILE_PHASE(kPrintPhase);
 	if (fXMLDecl) fXMLDecl->print(stream);
 	if (fDocType) fDocType->print(stream);
-	xmlvisitor v(stream);
-	tree_browser<xmlelement> browser(&v);
-	browser.browse(*elements());
+	if (cache && !fCache) fCache = new xmlprintcache;
+	xmlvisitor v(stream, cache ? fCache : 0);
+	v.print(elements());
 }
 
 }
@@ -22,6 +22,8 @@
 namespace MusicXML2 
 {
 
+class xmlprintcache;
+
 //______________________________________________________________________________
 class EXP TXMLDecl {
 	std::string fVersion;
@@ -49,6 +51,8 @@ class EXP TDocType {
 						: fStartElement(start), fPublic(pub), fPubLitteral(publit), fSysLitteral(syslit) {}
 		virtual ~TDocType() {}
 		void print (std::ostream& s);
+		//! the public identifier, empty when the document type is not public
+		const std::string&	publicId () const	{ return fPubLitteral; }
 };
 
 //______________________________________________________________________________
@@ -57,18 +61,23 @@ class EXP TXMLFile : public smartable
 	TXMLDecl *			fXMLDecl;
 	TDocType *			fDocType;
 	Sxmlelement			fXMLTree;
+	xmlprintcache *		fCache;		// created by the first cached print
     protected:
-				 TXMLFile() : fXMLDecl(0), fDocType(0) {}
-		virtual ~TXMLFile() { delete fXMLDecl; delete fDocType; }
+				 TXMLFile() : fXMLDecl(0), fDocType(0), fCache(0) {}
+		virtual ~TXMLFile();
 	public:
 		static SMARTP<TXMLFile> create();
 
 	public:		
 		Sxmlelement	elements()				{ return fXMLTree; }
+		const TDocType*	docType() const		{ return fDocType; }
 		void		set (Sxmlelement root)	{ fXMLTree = root; }
 		void		set (TXMLDecl * dec)	{ fXMLDecl = dec; }
 		void		set (TDocType * dt)		{ fDocType = dt; }
-		void		print (std::ostream& s);
+		//! prints the file, the cache allows to render only the elements modified since the last cached print
+		void		print (std::ostream& s, bool cache=false);
+		//! the print cache, null when the file has not been printed with the cache
+		const xmlprintcache*	printCache() const	{ return fCache; }
 };
 typedef SMARTP<TXMLFile> SXMLFile;
 
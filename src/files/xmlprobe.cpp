@@ -0,0 +1,230 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <iostream>
+#include <string.h>
+
+#include "elements.h"
+#include "mxlfile.h"
+#include "readerinternals.h"
+#include "xmlprobe.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//_______________________________________________________________________________
+// scoremetadata
+//_______________________________________________________________________________
+void scoremetadata::clear ()
+{
+	fRoot.clear();
+	fVersion.clear();
+	fWorkTitle.clear();
+	fWorkNumber.clear();
+	fMovementTitle.clear();
+	fMovementNumber.clear();
+	fCreators.clear();
+	fRights.clear();
+	fParts.clear();
+}
+
+string scoremetadata::title () const
+{
+	return fWorkTitle.size() ? fWorkTitle : fMovementTitle;
+}
+
+string scoremetadata::creatorOf (const char* type) const
+{
+	for (vector<creator>::const_iterator i = fCreators.begin(); i != fCreators.end(); i++)
+		if (i->first == type) return i->second;
+	return "";
+}
+
+//_______________________________________________________________________________
+// xmlprobe
+//_______________________________________________________________________________
+bool xmlprobe::probe (const char* file, scoremetadata& meta)
+{
+	lock_guard<recursive_mutex> lock (parserlock());
+	fMeta = &meta;
+	meta.clear();
+	fPath.clear();
+	fDone = false;
+	if (mxlfile::isMXL (file)) {
+		mxlfile mxl;
+		if (!mxl.open (file)) return false;
+		const mxlfile::entry* root = mxl.rootfile();
+		if (!root || !mxl.openEntry (*root)) return false;
+		return done (readsource (mxlsource, &mxl, this));
+	}
+	return done (readfile (file, this));
+}
+
+bool xmlprobe::probe (FILE* file, scoremetadata& meta)
+{
+	lock_guard<recursive_mutex> lock (parserlock());
+	fMeta = &meta;
+	meta.clear();
+	fPath.clear();
+	fDone = false;
+	return done (readstream (file, this));
+}
+
+bool xmlprobe::probebuff (const char* buffer, scoremetadata& meta)
+{
+	lock_guard<recursive_mutex> lock (parserlock());
+	fMeta = &meta;
+	meta.clear();
+	fPath.clear();
+	fDone = false;
+	return done (readbuffer (buffer, this));
+}
+
+// the tree is replayed as the parser would read it, up to the end of the header
+bool xmlprobe::probe (const SXMLFile& file, scoremetadata& meta)
+{
+	fMeta = &meta;
+	meta.clear();
+	fPath.clear();
+	fDone = false;
+	Sxmlelement root = file ? file->elements() : Sxmlelement();
+	if (!root) return done (false);
+	const TDocType* doctype = file->docType();
+	if (doctype) docType (0, true, doctype->publicId().c_str(), 0);
+	return done (replay (root));
+}
+
+bool xmlprobe::replay (const Sxmlelement& elt)
+{
+	if ((elt->getType() == kComment) || (elt->getType() == kProcessingInstruction)) return true;
+	const string& name = elt->getName();
+	if (!newElement (name.c_str())) return false;
+	const vector<Sxmlattribute>& attributes = elt->attributes();
+	for (vector<Sxmlattribute>::const_iterator i = attributes.begin(); i != attributes.end(); i++)
+		newAttribute ((*i)->getName().c_str(), (*i)->getValue().c_str());
+	for (ctree<xmlelement>::literator i = elt->lbegin(); i != elt->lend(); i++)
+		if (!replay (*i)) return false;
+	if (elt->elements().empty() && elt->getValue().size())
+		setValue (elt->getValue().c_str());
+	return endElement (name.c_str());
+}
+
+// the parsing is stopped at the end of the header: the parser then returns an error
+bool xmlprobe::done (bool status)
+{
+	bool ret = (status || fDone) && fMeta->fRoot.size();
+	fMeta = 0;
+	return ret;
+}
+
+//_______________________________________________________________________________
+// the version is also given by the public identifier, e.g. "-//Recordare//DTD MusicXML 2.0 Partwise//EN"
+// it is overridden by the root version attribute
+bool xmlprobe::docType (const char* start, bool status, const char *pub, const char *sys)
+{
+	const char* version = pub ? strstr (pub, "MusicXML ") : 0;
+	if (version) {
+		version += strlen ("MusicXML ");
+		fMeta->fVersion = string (version, strspn (version, "0123456789."));
+	}
+	return true;
+}
+
+//_______________________________________________________________________________
+// checks the current element parents
+bool xmlprobe::in (const char* parent, const char* grandparent) const
+{
+	size_t n = fPath.size();
+	if ((n < 2) || (fPath[n-2] != parent)) return false;
+	return !grandparent || ((n >= 3) && (fPath[n-3] == grandparent));
+}
+
+bool xmlprobe::newElement (const char* eltName)
+{
+	fPath.push_back (eltName);
+	size_t n = fPath.size();
+	if (n == 1)
+		fMeta->fRoot = eltName;
+	else if (n == 2) {
+		// a part or a measure ends the header, even without part-list
+		if (!strcmp (eltName, "part") || !strcmp (eltName, "measure")) {
+			fDone = true;
+			return false;
+		}
+	}
+	else if (!strcmp (eltName, "score-part") && in ("part-list"))
+		fMeta->fParts.push_back (scoremetadata::part());
+	else if (!strcmp (eltName, "creator"))
+		fCreatorType.clear();
+	return true;
+}
+
+bool xmlprobe::newAttribute (const char* name, const char *value)
+{
+	size_t n = fPath.size();
+	if ((n == 1) && !strcmp (name, "version"))
+		fMeta->fVersion = value;
+	else if ((fPath[n-1] == "score-part") && in ("part-list") && !strcmp (name, "id"))
+		fMeta->fParts.back().fId = value;
+	else if ((fPath[n-1] == "creator") && !strcmp (name, "type"))
+		fCreatorType = value;
+	return true;
+}
+
+void xmlprobe::setValue (const char* value)
+{
+	size_t n = fPath.size();
+	if (n < 2) return;
+	const string& elt = fPath[n-1];
+	if (n == 2) {
+		if (elt == "movement-title")		fMeta->fMovementTitle = value;
+		else if (elt == "movement-number")	fMeta->fMovementNumber = value;
+	}
+	else if (in ("work")) {
+		if (elt == "work-title")			fMeta->fWorkTitle = value;
+		else if (elt == "work-number")		fMeta->fWorkNumber = value;
+	}
+	else if (in ("identification")) {
+		if (elt == "creator")				fMeta->fCreators.push_back (scoremetadata::creator(fCreatorType, value));
+		else if (elt == "rights")			fMeta->fRights.push_back (value);
+	}
+	else if (in ("score-part", "part-list")) {
+		if (elt == "part-name")				fMeta->fParts.back().fName = value;
+		else if (elt == "part-abbreviation")	fMeta->fParts.back().fAbbreviation = value;
+	}
+	else if ((elt == "instrument-name") && in ("score-instrument", "score-part"))
+		fMeta->fParts.back().fInstruments.push_back (value);
+}
+
+bool xmlprobe::endElement (const char* eltName)
+{
+	if (fPath.empty() || (fPath.back() != eltName)) return false;
+	fPath.pop_back();
+	if (!strcmp (eltName, "part-list")) {
+		fDone = true;
+		return false;
+	}
+	return true;
+}
+
+void xmlprobe::error (const char* s, int lineno)
+{
+	if (!fDone) cerr << s << " on line " << lineno << endl;
+}
+
+}
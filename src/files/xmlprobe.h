@@ -0,0 +1,107 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __xmlprobe__
+#define __xmlprobe__
+
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exports.h"
+#include "reader.h"
+#include "xmlfile.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief A score metadata, as found in the score header.
+*/
+class EXP scoremetadata
+{
+	public:
+		typedef struct {
+			std::string		fId;
+			std::string		fName;				///< the part-name element
+			std::string		fAbbreviation;		///< the part-abbreviation element
+			std::vector<std::string>	fInstruments;	///< the score-instrument names
+		} part;
+		typedef std::pair<std::string, std::string>	creator;	///< the creator type and name
+
+		std::string		fRoot;				///< the root element name (score-partwise, score-timewise or opus)
+		std::string		fVersion;			///< the MusicXML version (root version attribute or document type), empty when not specified
+		std::string		fWorkTitle;
+		std::string		fWorkNumber;
+		std::string		fMovementTitle;
+		std::string		fMovementNumber;
+		std::vector<creator>	fCreators;
+		std::vector<std::string> fRights;
+		std::vector<part>	fParts;
+
+		void	clear ();
+		//! gives the work title or the movement title
+		std::string	title () const;
+		//! gives the first creator of a given type, empty when none
+		std::string	creatorOf (const char* type) const;
+		std::string	composer () const	{ return creatorOf ("composer"); }
+};
+
+//______________________________________________________________________________
+/*!
+\brief Reads the header of a score, without building the tree.
+
+	The source is scanned until the end of the \b part-list element and the
+	parsing is stopped: the parts content is never read. The metadata are
+	collected from the score header elements (\b work, \b movement-title,
+	\b movement-number, \b identification and \b part-list).
+	The compressed MusicXML files are supported by probe(const char*).
+	The metadata of a file already read are collected from its tree, using the
+	same rules. The reads are serialized with the xmlreader ones.
+*/
+class EXP xmlprobe : public reader
+{
+	scoremetadata*				fMeta;
+	std::vector<std::string>	fPath;		// the opened elements names
+	std::string					fCreatorType;
+	bool						fDone;		// the end of the header is reached
+
+	bool	in (const char* parent, const char* grandparent = 0) const;
+	bool	done (bool status);
+	bool	replay (const Sxmlelement& elt);
+
+	public:
+				 xmlprobe() : fMeta(0), fDone(false) {}
+		virtual ~xmlprobe() {}
+
+		//! reads the metadata of a file, returns false when the header is not a valid MusicXML header
+		bool	probe (const char* file, scoremetadata& meta);
+		bool	probe (FILE* file, scoremetadata& meta);
+		bool	probebuff (const char* buffer, scoremetadata& meta);
+		//! collects the metadata from the tree of a file
+		bool	probe (const SXMLFile& file, scoremetadata& meta);
+
+		bool	xmlDecl (const char* version, const char *encoding, int standalone)		{ return true; }
+		bool	docType (const char* start, bool status, const char *pub, const char *sys);
+
+		bool	newElement (const char* eltName);
+		bool	newAttribute (const char* eltName, const char *val);
+		void	setValue (const char* value);
+		bool	endElement (const char* eltName);
+		void	error (const char* s, int lineno);
+};
+
+}
+
+#endif
@@ -15,49 +15,184 @@
 #endif
 
 #include <iostream>
+#include <sstream>
+#include <fstream>
 #include "xmlreader.h"
 #include "factory.h"
+#include "mxlfile.h"
+#include "profiler.h"
+#include "readerinternals.h"
 
 using namespace std;
 
 namespace MusicXML2
 {
 
-extern "C" {
-bool readfile   (const char * file, reader * r);
-bool readstream (FILE * file, reader * r);
-bool readbuffer (const char * buffer, reader * r);
-}
-
 #if 0
 #define debug(str,val)	cerr << str << " - " << val << endl
 #else
 #define debug(str,val)
 #endif
 
+//_______________________________________________________________________________
+// the parser lock, shared with xmlprobe: a read may call another read
+// (e.g. readMXL calls readbuff when an index is set)
+recursive_mutex& parserlock ()
+{
+	static recursive_mutex lock;
+	return lock;
+}
+
+//_______________________________________________________________________________
+// the score entry is inflated by chunks directly into the parser
+size_t mxlsource (void * data, char * buf, size_t size)
+{
+	return ((mxlfile*)data)->read (buf, size);
+}
+
+//_______________________________________________________________________________
+bool readcontent (const char* file, string& content)
+{
+	content.clear();
+	FILE* fd = fopen (file, "rb");
+	if (!fd) return false;
+	char buffer[65536];
+	size_t n;
+	while ((n = fread (buffer, 1, sizeof(buffer), fd)) > 0)
+		content.append (buffer, n);
+	bool ok = !ferror (fd);
+	fclose (fd);
+	return ok;
+}
+
 //_______________________________________________________________________________
 SXMLFile xmlreader::readbuff(const char* buffer)
 {
+	PROFILE_PHASE(kParsePhase);
+	lock_guard<recursive_mutex> lock (parserlock());
 	fFile = TXMLFile::create();
 	debug("read buffer", '-');
-	return readbuffer (buffer, this) ? fFile : 0;
+	if (fIndex && !fIndex->build (buffer)) {
+		cerr << "measure index: unbalanced part or measure elements" << endl;
+		return 0;
+	}
+	if (!readbuffer (buffer, this)) return 0;
+	if (fIndex && !fIndex->bind (fFile->elements())) {
+		cerr << "measure index: the tree doesn't match the source" << endl;
+		return 0;
+	}
+	return fFile;
 }
 
 //_______________________________________________________________________________
+// utf-16 sources are reduced to 8 bits, as done by the lexer
+static string source (const string& content)
+{
+	if ((content.size() < 2) || !(((unsigned char)content[0] == 0xff) || ((unsigned char)content[0] == 0xfe)))
+		return content;
+	bool bigendian = ((unsigned char)content[0] == 0xfe);
+	string narrow;
+	for (size_t i = 2; i + 1 < content.size(); i += 2)
+		narrow += bigendian ? content[i+1] : content[i];
+	return narrow;
+}
+
+//_______________________________________________________________________________
+// the index is built from the source text: the file is read in memory first
 SXMLFile xmlreader::read(const char* file)
 {
-	fFile = TXMLFile::create();
+	PROFILE_PHASE(kParsePhase);
+	lock_guard<recursive_mutex> lock (parserlock());
 	debug("read", file);
+	if (mxlfile::isMXL (file)) return readMXL (file);
+	if (fIndex) {
+		ifstream in (file, ios::in | ios::binary);
+		if (!in.is_open()) {
+			cerr << "can't open file " << file << endl;
+			return 0;
+		}
+		ostringstream content;
+		content << in.rdbuf();
+		return readbuff (source (content.str()).c_str());
+	}
+	fFile = TXMLFile::create();
 	return readfile (file, this) ? fFile : 0;
 }
 
+SXMLFile xmlreader::readMXL(const char* file)
+{
+	PROFILE_PHASE(kParsePhase);
+	lock_guard<recursive_mutex> lock (parserlock());
+	debug("read mxl", file);
+	mxlfile mxl;
+	if (!mxl.open (file)) return 0;
+	return readMXL (mxl, file);
+}
+
+SXMLFile xmlreader::readMXL(mxlfile& mxl, const char* name)
+{
+	const mxlfile::entry* root = mxl.rootfile();
+	if (!root) {
+		cerr << name << ": score not found" << endl;
+		return 0;
+	}
+	if (fIndex) {
+		string content;
+		if (!mxl.extract (*root, content)) return 0;
+		return readbuff (source (content).c_str());
+	}
+	if (!mxl.openEntry (*root)) return 0;
+	fFile = TXMLFile::create();
+	// the data are checked at the end of the entry: a parsed score may be incorrect
+	return (readsource (mxlsource, &mxl, this) && !mxl.failed()) ? fFile : 0;
+}
+
+//_______________________________________________________________________________
+// the content is parsed as read: the caller may have hashed or checked it
+SXMLFile xmlreader::readcontent(const string& content)
+{
+	PROFILE_PHASE(kParsePhase);
+	lock_guard<recursive_mutex> lock (parserlock());
+	debug("read content", content.size());
+	if (mxlfile::isMXLContent (content)) {
+		mxlfile mxl;
+		if (!mxl.openContent (content)) return 0;
+		return readMXL (mxl, "archive");
+	}
+	return readbuff (source (content).c_str());
+}
+
 //_______________________________________________________________________________
 SXMLFile xmlreader::read(FILE* file)
 {
+	PROFILE_PHASE(kParsePhase);
+	lock_guard<recursive_mutex> lock (parserlock());
+	if (fIndex && file) {
+		string content;
+		char buff[4096];
+		size_t n;
+		while ((n = fread (buff, 1, sizeof(buff), file)) > 0)
+			content.append (buff, n);
+		return readbuff (source (content).c_str());
+	}
 	fFile = TXMLFile::create();
 	return readstream (file, this) ? fFile : 0;
 }
 
+//_______________________________________________________________________________
+// only the parts and measures including the edits are parsed again, unless
+// the edits are outside these elements
+SXMLFile xmlreader::update(SXMLFile file, const char* buffer, const vector<measureindex::edit>& edits, vector<int>& replaced)
+{
+	lock_guard<recursive_mutex> lock (parserlock());
+	replaced.clear();
+	if (fIndex && file && fIndex->root() && ((xmlelement*)fIndex->root() == (xmlelement*)file->elements())) {
+		debug("update", '-');
+		if (fIndex->update (buffer, edits, replaced)) return file;
+	}
+	return readbuff (buffer);
+}
+
 //_______________________________________________________________________________
 void xmlreader::newComment (const char* comment)
 {
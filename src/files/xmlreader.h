@@ -14,27 +14,55 @@
 #define __xmlreader__
 
 #include <stack>
+#include <string>
 #include <stdio.h>
 #include "exports.h"
+#include "measureindex.h"
 #include "xmlfile.h"
 #include "reader.h"
 
 namespace MusicXML2 
 {
 
+class mxlfile;
+
 //______________________________________________________________________________
+/*!
+\brief The MusicXML reader.
+
+	The parser is not reentrant: the reads are serialized by a process-wide lock,
+	shared with xmlprobe, and may be called from concurrent threads.
+*/
 class EXP xmlreader : public reader
 { 
 	std::stack<Sxmlelement>	fStack;
 	SXMLFile				fFile;
+	measureindex*			fIndex;
 
 	public:
-				 xmlreader() {}
+				 xmlreader() : fIndex(0) {}
 		virtual ~xmlreader() {}
 		
 		SXMLFile readbuff(const char* file);
 		SXMLFile read(const char* file);
 		SXMLFile read(FILE* file);
+		//! reads a compressed MusicXML file, also used by read(const char*) for the zip archives
+		SXMLFile readMXL(const char* file);
+		//! reads a file content read in memory: a MusicXML text (8 bits or utf-16) or a zip archive
+		SXMLFile readcontent(const std::string& content);
+
+		/*! updates a file read with the index from a new source
+			\param file a file read with the index
+			\param buffer the new source
+			\param edits the edits from the previous source (see measureindex::update)
+			\param replaced on output, the indexes of the parts and measures spans parsed again
+			\return the updated file, or a new file when a complete read was required (replaced is then empty)
+		*/
+		SXMLFile update(SXMLFile file, const char* buffer, const std::vector<measureindex::edit>& edits, std::vector<int>& replaced);
+
+		//! sets an optional index of the parts and measures, built and bound to the tree by the next reads
+		//! (the reads fail when the index can't be built or bound)
+		void	setIndex (measureindex* index)		{ fIndex = index; }
 
 		bool	xmlDecl (const char* version, const char *encoding, int standalone);
 		bool	docType (const char* start, bool status, const char *pub, const char *sys);
@@ -46,6 +74,9 @@ class EXP xmlreader : public reader
 		void	setValue (const char* value);
 		bool	endElement (const char* eltName);
 		void	error (const char* s, int lineno);
+
+	private:
+		SXMLFile readMXL(mxlfile& mxl, const char* name);
 };
 
 }
@@ -12,6 +12,7 @@
 
 #include <sstream>
 #include "guido.h"
+#include "profiler.h"
 
 using namespace std;
 
@@ -97,7 +98,7 @@ long guidoelement::add (Sguidoparam param) {
 }
 
 //______________________________________________________________________________
-void guidoelement::print(ostream& os)
+void guidoelement::printHeader(ostream& os) const
 {
     os << fName;
 
@@ -115,78 +116,120 @@ void guidoelement::print(ostream& os)
         }
         os << ">";
     }
+}
+
+//______________________________________________________________________________
+void guidoelement::print(ostream& os)
+{
+    printHeader (os);
 
-    bool isSeq = dynamic_cast<const guidoseq *>(this) != 0;
-    bool isChord = dynamic_cast<const guidochord *>(this) != 0;
-    bool prevNote = false;
-    bool prevSeq = false;
-    bool prevEnclosedTag = false;
     // print the optional contained elements
     if (!fElements.empty()) {
         os << fStartList;
+        guidoseparator sep (this);
         vector<Sguidoelement>::const_iterator ielt;
         for (ielt = fElements.begin(); ielt != fElements.end(); ielt++) {
-            Sguidoseq seq;
-            seq.cast((guidoelement *)(*ielt));
-            Sguidonote note;
-            note.cast((guidoelement *)(*ielt));
-            Sguidotag tag;
-            tag.cast((guidoelement *)(*ielt));
-            bool beginTag = false, endTag = false;
-            if (tag)
-            {
-                if (tag->fName.find("End") != std::string::npos)
-                {
-                    endTag = true;
-                }else if (tag->fName.find("Begin") != std::string::npos)
-                {
-                    beginTag = true;
-                }
-            }
-            
-            // special treatment for Chord Separator
-            if (isChord) {
-                if (note) {
-                    os << (prevEnclosedTag || prevNote ? ", " : " ");
-                    prevNote = true;
-                    prevEnclosedTag = false;
-                }
-                else if (seq) {
-                    os << (prevSeq ? ", " : " ");
-                    prevSeq = true;
-                }else if (tag) {
-                    if (beginTag)
-                    {
-                        // happens BEFORE a note. So it should be closed by a separator if in the middle
-                        os << ( (prevNote||prevSeq) ? ", " : " ");
-                        // but it should NOT be followed next time by a separator!
-                        prevNote = false;
-                        
-                    }else if (endTag)
-                    {
-                        // this happens AFTER a note. So it should be preceded by a " ". It should be followed by a ',' if next is note!
-                        os << " ";
-                            
-                    }else {
-                        // A regular enclosing tag like \tag(...) . This SHOULD be followed by a ',' if next is note!
-                        os << ( (prevNote||prevSeq||prevEnclosedTag) ? ", " : " ");
-                        prevEnclosedTag = true;
-                    }
-                }
-                else os << " ";
-                
-            }
-            else os << " ";
-            os << *ielt;
+            os << sep.next(*ielt);
+            (*ielt)->print(os);		// not operator<<, which profiles the top-level print
         }
        os << fEndList;
     }
-	if (isSeq) os << std::endl;
+	if (dynamic_cast<const guidoseq *>(this)) os << std::endl;
+}
+
+//______________________________________________________________________________
+guidoseparator::guidoseparator(const guidoelement* container)
+	: fPrevNote(false), fPrevSeq(false), fPrevEnclosedTag(false)
+{
+	fChord = dynamic_cast<const guidochord *>(container) != 0;
+}
+
+const char* guidoseparator::next (const Sguidoelement& elt)
+{
+    // special treatment for Chord Separator
+    if (!fChord) return " ";
+
+    Sguidoseq seq;
+    seq.cast((guidoelement *)elt);
+    Sguidonote note;
+    note.cast((guidoelement *)elt);
+    Sguidotag tag;
+    tag.cast((guidoelement *)elt);
+
+    const char* sep = " ";
+    if (note) {
+        sep = (fPrevEnclosedTag || fPrevNote ? ", " : " ");
+        fPrevNote = true;
+        fPrevEnclosedTag = false;
+    }
+    else if (seq) {
+        sep = (fPrevSeq ? ", " : " ");
+        fPrevSeq = true;
+    }
+    else if (tag) {
+        string name = tag->getName();
+        if (name.find("End") != std::string::npos) {
+            // this happens AFTER a note. So it should be preceded by a " ". It should be followed by a ',' if next is note!
+            sep = " ";
+        }
+        else if (name.find("Begin") != std::string::npos) {
+            // happens BEFORE a note. So it should be closed by a separator if in the middle
+            sep = ( (fPrevNote||fPrevSeq) ? ", " : " ");
+            // but it should NOT be followed next time by a separator!
+            fPrevNote = false;
+        }
+        else {
+            // A regular enclosing tag like \tag(...) . This SHOULD be followed by a ',' if next is note!
+            sep = ( (fPrevNote||fPrevSeq||fPrevEnclosedTag) ? ", " : " ");
+            fPrevEnclosedTag = true;
+        }
+    }
+    return sep;
+}
+
+//______________________________________________________________________________
+// guidowriter
+//______________________________________________________________________________
+void guidowriter::enclose (const Sguidoelement& elt)
+{
+	if (fStack.empty()) return;
+	level& l = fStack.back();
+	if (l.fEmpty) {
+		fOut << l.fElt->getStart();
+		l.fEmpty = false;
+	}
+	fOut << l.fSep.next(elt);
+}
+
+void guidowriter::open (const Sguidoelement& elt)
+{
+	enclose (elt);
+	elt->printHeader (fOut);
+	level l = { elt, guidoseparator(elt), true };
+	fStack.push_back (l);
+}
+
+void guidowriter::write (const Sguidoelement& elt)
+{
+	enclose (elt);
+	elt->print (fOut);		// the streamed output is part of the guido phase
+}
+
+void guidowriter::close ()
+{
+	if (fStack.empty()) return;
+	const level& l = fStack.back();
+	if (!l.fEmpty) fOut << l.fElt->getEnd();
+	if (dynamic_cast<const guidoseq *>((guidoelement*)l.fElt)) fOut << std::endl;
+	fStack.pop_back();
 }
 
 //______________________________________________________________________________
+// the print phase is the print of a whole tree: the elements print their
+// sub-elements using print()
 ostream& operator<< (ostream& os, const Sguidoelement& elt)
 {
+    PROFILE_PHASE(kPrintPhase);
     elt->print(os);
     return os;
 }
@@ -231,7 +274,7 @@ void guidonote::set (unsigned short voice, string name, char octave, guidonotedu
 }
 
 //______________________________________________________________________________
-guidoelement::guidoelement(string name, string sep) : fName(name), fSep(sep) {}
+guidoelement::guidoelement(string name, string sep) : fName(name), fSep(sep) { PROFILE_COUNT(kGuidoElements, 1); }
 guidoelement::~guidoelement() {}
 
 //______________________________________________________________________________
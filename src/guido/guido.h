@@ -76,6 +76,8 @@ class EXP guidoelement : public smartable {
 		long add (Sguidoparam& param);
 		long add (Sguidoparam param);
 		void print (std::ostream& os);
+		//! prints the element name and its parameters only
+		void printHeader (std::ostream& os) const;
 
 		//! the element name
 		void 	setName (std::string name)			{ fName = name; }
@@ -250,6 +252,59 @@ class EXP guidotag : public guidoelement {
 		virtual ~guidotag();
 };
 typedef SMARTP<guidotag> Sguidotag;
+
+/*!
+\brief Computes the separators between the elements enclosed in a guido element.
+
+	Elements are separated by a space, except in chords where notes, sequences
+	and tags are separated by commas.
+*/
+class EXP guidoseparator {
+	public:
+				 guidoseparator(const guidoelement* container);
+		virtual ~guidoseparator() {}
+
+		//! gives the separator to be written before the next enclosed element
+		const char* next (const Sguidoelement& elt);
+
+	private:
+		bool fChord, fPrevNote, fPrevSeq, fPrevEnclosedTag;
+};
+
+/*!
+\brief Writes guido elements to a stream as soon as they are complete.
+
+	The open elements are kept on a stack: an element is opened, the elements
+	it encloses are written one by one (and may be released by the caller),
+	and the element is closed. The output is the same as the output of the
+	corresponding guido tree, but the tree never needs to be entirely built.
+	Note that all the parameters of an element must be set when it is opened.
+*/
+class EXP guidowriter {
+	public:
+				 guidowriter(std::ostream& out) : fOut(out) {}
+		virtual ~guidowriter() {}
+
+		//! writes the element name and parameters, next elements are enclosed in elt
+		void open	(const Sguidoelement& elt);
+		//! writes a complete element, enclosed in the current open element
+		void write	(const Sguidoelement& elt);
+		//! closes the current open element
+		void close	();
+		int	 depth	() const		{ return int(fStack.size()); }
+
+	private:
+		typedef struct {
+			Sguidoelement	fElt;
+			guidoseparator	fSep;
+			bool			fEmpty;
+		} level;
+
+		std::ostream&		fOut;
+		std::vector<level>	fStack;
+
+		void enclose (const Sguidoelement& elt);
+};
 /*! @} */
 
 }
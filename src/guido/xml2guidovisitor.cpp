@@ -19,6 +19,7 @@
 #include <string>
 
 #include "partsummary.h"
+#include "profiler.h"
 #include "rational.h"
 #include "xml_tree_browser.h"
 #include "xml2guidovisitor.h"
@@ -32,7 +33,7 @@ namespace MusicXML2
     
     //______________________________________________________________________________
     xml2guidovisitor::xml2guidovisitor(bool generateComments, bool generateStem, bool generateBar) :
-    fGenerateComments(generateComments), fGenerateStem(generateStem),
+    fWriter(0), fGenerateComments(generateComments), fGenerateStem(generateStem),
     fGenerateBars(generateBar), fGeneratePositions(true),
     fCurrentStaffIndex(0), previousStaffHasLyrics(false), fCurrentAccoladeIndex(0)
     {}
@@ -40,6 +41,7 @@ namespace MusicXML2
     //______________________________________________________________________________
     Sguidoelement xml2guidovisitor::convert (const Sxmlelement& xml)
     {
+        PROFILE_PHASE(kGuidoPhase);
         Sguidoelement gmn;
         if (xml) {
             tree_browser<xmlelement> browser(this);
@@ -49,6 +51,20 @@ namespace MusicXML2
         return gmn;
     }
     
+    //______________________________________________________________________________
+    void xml2guidovisitor::convert (const Sxmlelement& xml, ostream& out)
+    {
+        PROFILE_PHASE(kGuidoPhase);
+        if (xml) {
+            guidowriter w(out);
+            fWriter = &w;
+            tree_browser<xmlelement> browser(this);
+            browser.browse(*xml);
+            while (w.depth()) w.close();
+            fWriter = 0;
+        }
+    }
+    
     //______________________________________________________________________________
     // the score header contains information like title, author etc..
     // it must be written only once, at the beginning of the first guido voice
@@ -150,6 +166,7 @@ namespace MusicXML2
     {
         Sguidoelement chord = guidochord ::create();
         start(chord);
+        if (fWriter) fWriter->open (chord);
     }
     
     //______________________________________________________________________________
@@ -162,8 +179,11 @@ namespace MusicXML2
     void xml2guidovisitor::visitStart ( S_part& elt )
     {
         partsummary ps;
-        xml_tree_browser browser(&ps);
-        browser.browse(*elt);
+        {
+            PROFILE_PHASE(kPartSummaryPhase);
+            xml_tree_browser browser(&ps);
+            browser.browse(*elt);
+        }
         
         smartlist<int>::ptr voices = ps.getVoices ();
         int targetStaff = 0xffff;	// initialized to a value we'll unlikely encounter
@@ -187,7 +207,11 @@ namespace MusicXML2
             }
             
             Sguidoelement seq = guidoseq::create();
-            push (seq);
+            if (fWriter) {
+                start (seq);				// the sequence is written, not stored in the chord
+                fWriter->open (seq);
+            }
+            else push (seq);
             
             Sguidoelement tag = guidotag::create("staff");
             tag->add (guidoparam::create(fCurrentStaffIndex, false));
@@ -261,7 +285,17 @@ namespace MusicXML2
             pv.initialize(seq, targetStaff, fCurrentStaffIndex, targetVoice, notesOnly, currentTimeSign);
             pv.staffClefMap = staffClefMap;
             pv.timePositions = timePositions;
-            browser.browse(*elt);
+            pv.setWriter (fWriter);
+            {
+                PROFILE_PHASE(kVoicesPhase);
+                PROFILE_COUNT(kVoicePasses, 1);
+                browser.browse(*elt);
+            }
+            if (fWriter) {
+                for (vector<Sguidoelement>::const_iterator e = seq->elements().begin(); e != seq->elements().end(); e++)
+                    fWriter->write (*e);
+                fWriter->close();
+            }
             pop();
             currentTimeSign = pv.getTimeSign();
             previousStaffHasLyrics = pv.hasLyrics();
@@ -64,6 +64,7 @@ class EXP xml2guidovisitor :
 {
 	// the guido elements stack
 	std::stack<Sguidoelement>	fStack;
+	guidowriter*	fWriter;		// the optional writer used for the streaming conversion
 	bool	fGenerateComments, fGenerateStem, fGenerateBars, fGeneratePositions;
 	
 	scoreHeader		fHeader;		// musicxml header elements (should be flushed at the beginning of the first voice)
@@ -107,6 +108,10 @@ class EXP xml2guidovisitor :
 		virtual ~xml2guidovisitor() {}
 
 		Sguidoelement convert (const Sxmlelement& xml);
+		/*! converts and writes the guido code as it goes, without building the whole guido tree:
+			the elements are released at the end of each measure
+		*/
+		void convert (const Sxmlelement& xml, std::ostream& out);
 
 		// this is to control exact positionning of elements when information is present
 		// ie converts relative-x/-y into dx/dy attributes
@@ -32,7 +32,7 @@ namespace MusicXML2
     fGenerateComments(generateComments), //fGenerateStem(generateStem),
     fGenerateBars(generateBar),
     fNotesOnly(false), fCurrentStaffIndex(0), fCurrentStaff(0),
-    fTargetStaff(0), fTargetVoice(0)
+    fTargetStaff(0), fTargetVoice(0), fWriter(0)
     {
         fGeneratePositions = true;
         fGenerateAutoMeasureNum = true;
@@ -117,6 +117,19 @@ namespace MusicXML2
         }
     }
     
+    //______________________________________________________________________________
+    // when a writer is set, the elements of the sequence are written as soon as
+    // no element remains open (i.e. the sequence is the only element on the stack)
+    void xmlpart2guido::flush ()
+    {
+        if (fWriter && (fStack.size() == 1)) {
+            vector<Sguidoelement>& elts = current()->elements();
+            for (vector<Sguidoelement>::const_iterator i = elts.begin(); i != elts.end(); i++)
+                fWriter->write (*i);
+            elts.clear();
+        }
+    }
+    
     //______________________________________________________________________________
     void xmlpart2guido::stackClean ()
     {
@@ -352,6 +365,7 @@ namespace MusicXML2
                 fDoubleBar = true;
             
         }
+        flush();
     }
     
     //______________________________________________________________________________
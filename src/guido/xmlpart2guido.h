@@ -115,6 +115,7 @@ class EXP xmlpart2guido :
 	int		fCurrentTupletNumber;		// number attribute of the current tuplet
 	int		fCurrentStemDirection;	// the current stems direction, used for stem direction changes
 	int		fPendingPops;			// elements to be popped at chord exit (like fermata, articulations...)
+	guidowriter* fWriter;			// an optional writer, the completed elements are flushed to the writer at the end of each measure
 
 	void start (Sguidoelement& elt)		{ fStack.push(elt); }
 	void add  (Sguidoelement& elt)		{ fStack.top()->add(elt); }
@@ -122,6 +123,7 @@ class EXP xmlpart2guido :
 	void checkDelayed (long time);						// checks the delayed elements for ready elements 
 	void push (Sguidoelement& elt)		{ add(elt); fStack.push(elt); }
 	void pop ()							{ fStack.pop(); }
+	void flush ();
 
 	void moveMeasureTime (int duration, bool moveVoiceToo=false, int x_default = 0);
 	void reset ();
@@ -217,6 +219,8 @@ class EXP xmlpart2guido :
 		Sguidoelement& current ()					{ return fStack.top(); }
 		void	initialize (Sguidoelement seq, int staff, int guidostaff, int voice, bool notesonly, rational defaultTimeSign);
 		void	generatePositions (bool state)		{ fGeneratePositions = state; }
+		//! the completed elements of the sequence are written to w and released at the end of each measure
+		void	setWriter (guidowriter* w)			{ fWriter = w; }
 		const rational& getTimeSign () const		{ return fCurrentTimeSign; }
         bool fHasLyrics;
         bool hasLyrics() const {return fHasLyrics;}
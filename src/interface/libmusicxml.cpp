@@ -12,8 +12,10 @@
 
 #include <vector>
 
+#include "doccache.h"
 #include "libmusicxml.h"
 #include "musicxmlfactory.h"
+#include "profiler.h"
 #include "versions.h"
 
 using namespace std;
@@ -24,8 +26,43 @@ EXP float		musicxmllibVersion()			{ return versions::libVersion(); }
 EXP const char* musicxmllibVersionStr()			{ return versions::libVersionStr(); }
 EXP float		musicxml2guidoVersion()			{ return versions::xml2guidoVersion(); }
 EXP	const char* musicxml2guidoVersionStr()		{ return versions::xml2guidoVersionStr(); }
-//EXP int			musicxml2antescofoVersion()			{ return versions::xml2antescofoVersion(); }
-//EXP	const char* musicxml2antescofoVersionStr()		{ return versions::xml2antescofoVersionStr(); }
+EXP float		musicxml2antescofoVersion()		{ return versions::xml2antescofoVersion(); }
+EXP	const char* musicxml2antescofoVersionStr()	{ return versions::xml2antescofoVersionStr(); }
+
+
+//------------------------------------------------------------------------
+// instrumentation
+//------------------------------------------------------------------------
+static const char* gPhasesNames[kPhasesCount]		= { "parse", "partsummary", "voices", "guido", "midi", "print" };
+static const char* gCountersNames[kCountersCount]	= { "nodes_created", "bytes_lexed", "visitor_callbacks", "voice_passes", "guido_elements" };
+
+#ifdef MUSICXMLPROFILING
+EXP bool	musicxmlProfiling()						{ return true; }
+#else
+EXP bool	musicxmlProfiling()						{ return false; }
+#endif
+EXP void	musicxmlProfile (TProfile& profile)		{ profiler::snapshot (profile); }
+EXP void	musicxmlProfileReset()					{ profiler::reset(); }
+
+EXP void	musicxmlProfileJSON (ostream& out)
+{
+	TProfile p;
+	profiler::snapshot (p);
+	out << "{\n  \"enabled\": " << (musicxmlProfiling() ? "true" : "false") << ",\n  \"phases\": {";
+	for (int i = 0; i < kPhasesCount; i++)
+		out << (i ? "," : "") << "\n    \"" << gPhasesNames[i] << "\": { \"seconds\": " << p.time[i] << ", \"calls\": " << p.calls[i] << " }";
+	out << "\n  },\n  \"counters\": {";
+	for (int i = 0; i < kCountersCount; i++)
+		out << (i ? "," : "") << "\n    \"" << gCountersNames[i] << "\": " << p.counters[i];
+	out << "\n  }\n}" << endl;
+}
+
+//------------------------------------------------------------------------
+// documents cache
+//------------------------------------------------------------------------
+EXP void	musicxmlCacheBudget (unsigned long bytes, bool outputs)	{ doccache::budget (bytes, outputs); }
+EXP void	musicxmlCacheClear()						{ doccache::clear(); }
+EXP void	musicxmlCacheStats (TCacheStats& stats)		{ doccache::stats (stats); }
  
 
 //------------------------------------------------------------------------
@@ -79,6 +116,8 @@ EXP TElement	factoryNote	(TFactory f, const char* step, float alter, int octave,
 	{ return __retainElt (f->newnote (step, alter, octave, duration, type)); }
 EXP TElement	factoryRest	(TFactory f, int duration, const char* type)
 	{ return __retainElt (f->newrest (duration, type)); }
+EXP void		factoryAddNotes	(TFactory f, TElement measure, const TNote* notes, int count)
+	{ f->addnotes (measure, notes, count); }
 EXP TElement	factoryDynamic	(TFactory f, int type, const char* placement)
 	{ return __retainElt (f->newdynamics (type, placement)); }
 EXP TElement	factoryBarline	(TFactory f, const char* location, const char* barstyle, const char *repeat)
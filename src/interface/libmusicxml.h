@@ -10,6 +10,9 @@
   research@grame.fr
 */
 
+#ifndef __libmusicxml__
+#define __libmusicxml__
+
 #ifdef VC6
 # pragma warning (disable : 4786)
 #endif
@@ -35,6 +38,23 @@ typedef xmlelement*		TElement;
 typedef xmlattribute*	TAttribute;
 typedef musicxmlfactory* TFactory;
 
+/*!
+	\brief A note description, used for the bulk notes creation (see factoryAddNotes())
+*/
+typedef struct {
+	const char*	step;		///< the pitch step using letters A through G, a null value makes a rest
+	float		alter;		///< chromatic alteration in number of semitones (0 prevents the alter element creation)
+	int			octave;		///< a number in 0 to 9, where 4 indicates the octave started by middle C
+	int			duration;	///< the sounding duration (in divisions count) (0 prevents the duration element creation)
+	const char*	type;		///< the graphic note type (a null value prevents the type element creation)
+	int			voice;		///< the note voice (0 prevents the voice element creation)
+	int			staff;		///< the note staff (0 prevents the staff element creation)
+	int			flags;		///< a combination of the TNote flags below
+} TNote;
+
+//! TNote flags
+enum { kNoteChord=1, kNoteTieStart=2, kNoteTieStop=4 };
+
 
 /*!
 	\brief Gives the library version number.
@@ -48,6 +68,105 @@ EXP float				musicxmllibVersion();
 EXP const char*		musicxmllibVersionStr();
 
 
+/*!
+\addtogroup Instrumentation
+
+The library includes an optional instrumentation of its main phases and counters.
+It is enabled at compile time using the MUSICXMLPROFILING definition (the cmake
+PROFILING option) and requires C++11. When disabled, it has no cost and the
+snapshots are empty.
+
+The phases times are inclusive: the partsummary and voices phases are part of the
+guido phase. The values are aggregated over all the threads.
+@{
+*/
+
+//! the instrumented phases
+enum { kParsePhase, kPartSummaryPhase, kVoicesPhase, kGuidoPhase, kMidiPhase, kPrintPhase, kPhasesCount };
+//! the instrumentation counters
+enum { kNodesCreated, kBytesLexed, kVisitorCallbacks, kVoicePasses, kGuidoElements, kCountersCount };
+
+/*!
+	\brief An instrumentation snapshot
+*/
+typedef struct {
+	double			time[kPhasesCount];			///< the time spent in each phase, in seconds
+	unsigned long	calls[kPhasesCount];		///< the count of entries in each phase
+	unsigned long	counters[kCountersCount];	///< the counters values
+} TProfile;
+
+/*!
+	\brief Gives the instrumentation state.
+	\return true when the library is compiled with the instrumentation
+*/
+EXP bool			musicxmlProfiling();
+/*!
+	\brief Gives the instrumentation values aggregated over all the threads.
+	\param profile on output, the instrumentation values
+*/
+EXP void			musicxmlProfile		(TProfile& profile);
+/*!
+	\brief Writes the instrumentation values in JSON format.
+	\param out the output stream
+*/
+EXP void			musicxmlProfileJSON	(std::ostream& out);
+/*!
+	\brief Clears the instrumentation values.
+*/
+EXP void			musicxmlProfileReset();
+/*! @} */
+
+
+/*!
+\addtogroup Cache Documents cache
+
+The guido and antescofo conversion functions may use a process-wide cache of the
+parsed documents, indexed by a hash of their content: the repeated conversions of
+a score skip the parsing. The conversions outputs may be cached as well, per
+converter and options. The cache is bounded by a bytes budget, the least recently
+used entries are dropped first. It is disabled by default.
+
+With the cache enabled, a conversion output is built in memory and written to the
+output stream at the end of the conversion: the guido output is not streamed as
+it is without the cache. A file is read once, its content is hashed and parsed.
+
+The cache lookups are thread safe. Since the parser and the converters are not
+reentrant, the conversions using the cache are serialized.
+The file descriptors entry points don't use the cache.
+@{
+*/
+
+/*!
+	\brief The cache statistics
+*/
+typedef struct {
+	unsigned long	hits;			///< the count of documents found in the cache
+	unsigned long	misses;			///< the count of documents parsed
+	unsigned long	outputHits;		///< the count of outputs found in the cache
+	unsigned long	documents;		///< the count of cached documents
+	unsigned long	outputs;		///< the count of cached outputs
+	unsigned long	bytes;			///< the memory used by the cached entries (estimated)
+	unsigned long	budget;			///< the cache budget
+} TCacheStats;
+
+/*!
+	\brief Sets the documents cache budget.
+	\param bytes the maximum memory used by the cache, 0 disables the cache
+	\param outputs a boolean to cache the conversions outputs too
+*/
+EXP void			musicxmlCacheBudget	(unsigned long bytes, bool outputs);
+/*!
+	\brief Drops the cached entries and clears the statistics.
+*/
+EXP void			musicxmlCacheClear();
+/*!
+	\brief Gives the cache statistics.
+	\param stats on output, the cache statistics
+*/
+EXP void			musicxmlCacheStats	(TCacheStats& stats);
+/*! @} */
+
+
 /*!
 \addtogroup Converting MusicXML to Guido Music Notation format
 
@@ -97,24 +216,65 @@ EXP xmlErr			musicxmlstring2guido(const char *buff, bool generateBars, std::ostr
 /*! @} */
 
 
-/*
+/*!
+\addtogroup Converting MusicXML to MIDI
+
+The library includes a high level API to convert from the MusicXML format to a 
+Standard MIDI File (type 1). The score is unrolled before conversion: repeats and
+jumps are played as expected by a performer.
+@{
+*/
+
+/*!
+	\brief Converts a MusicXML representation to a Standard MIDI File.
+	\param file a file name 
+	\param tpq the ticks per quarter note resolution of the MIDI file
+	\param out the output stream (should be opened in binary mode)
+	\return an error code (\c kNoErr when success)
+*/
+EXP xmlErr			musicxmlfile2midi	(const char *file, int tpq, std::ostream& out);
+
+/*!
+	\brief Converts a MusicXML representation to a Standard MIDI File.
+	\param fd a file descriptor 
+	\param tpq the ticks per quarter note resolution of the MIDI file
+	\param out the output stream (should be opened in binary mode)
+	\return an error code (\c kNoErr when success)
+*/
+EXP xmlErr			musicxmlfd2midi		(FILE* fd, int tpq, std::ostream& out);
+
+/*!
+	\brief Converts a MusicXML representation to a Standard MIDI File.
+	\param buff a string containing MusicXML code
+	\param tpq the ticks per quarter note resolution of the MIDI file
+	\param out the output stream (should be opened in binary mode)
+	\return an error code (\c kNoErr when success)
+*/
+EXP xmlErr			musicxmlstring2midi	(const char *buff, int tpq, std::ostream& out);
+/*! @} */
+
+
+/*!
 \addtogroup Converting MusicXML to Antescofo Music Notation format
 
 The library includes a high level API to convert from the MusicXML format to the
 Antescofo Score Notation format. For more information about this format, 
 see  http://repmus.ircam.fr/antescofo
+
+The conversion is made in memory: the output is sent to the stream with a single write.
 @{
 */
 
-/*
+/*!
 	\brief Gives the Antescofo converter version number.
-	\return a version number as an integer (e.g. version 1.0.0 is returned as 100)
-
-EXP int				musicxml2antescofoVersion();
+	\return a version number as a float value
+*/
+EXP float				musicxml2antescofoVersion();
+/*!
 	\brief Gives the Antescofo converter version as a string.
 	\return a string
-EXP	const char*		musicxml2antescofoVersionStr();
 */
+EXP	const char*		musicxml2antescofoVersionStr();
 
 /*!
 	\brief Converts a MusicXML representation to the Antescofo format.
@@ -122,8 +282,8 @@ EXP	const char*		musicxml2antescofoVersionStr();
 	\param generateBars a boolean to force barlines generation
 	\param out the output stream
 	\return an error code (\c kNoErr when success)
-EXP xmlErr			musicxmlfile2antescofo	(const char *file, bool generateBars, std::ostream& out);
 */
+EXP xmlErr			musicxmlfile2antescofo	(const char *file, bool generateBars, std::ostream& out);
 
 /*!
 	\brief Converts a MusicXML representation to the Antescofo format.
@@ -142,6 +302,15 @@ EXP xmlErr			musicxmlfd2antescofo	(FILE* fd, bool generateBars, std::ostream& ou
 	\return an error code (\c kNoErr when success)
 */
 EXP xmlErr			musicxmlstring2antescofo(const char *buff, bool generateBars, std::ostream& out);
+
+/*!
+	\brief Converts a MusicXML representation to the Antescofo format.
+	\param buff a string containing MusicXML code
+	\param generateBars a boolean to force barlines generation
+	\param out a string that receives the Antescofo code (its previous content is replaced)
+	\return an error code (\c kNoErr when success)
+*/
+EXP xmlErr			musicxmlstring2antescofostring(const char *buff, bool generateBars, std::string& out);
 /*! @} */
 
 
@@ -154,7 +323,9 @@ EXP xmlErr			musicxmlstring2antescofo(const char *buff, bool generateBars, std::
 	The factory provides a high level API to build a MusicXML tree but gives also a low 
 	level access to the music representation. The idea is to make simple scores easy to build	
 	while complex scores accessible with a godd knowledge of the MusicXML format.
-	The main feature of the factory is the automatic sort of the representation according to the dtd.
+	The main feature of the factory is the automatic sort of the representation according to the dtd:
+	elements are inserted at their place when they are added, the tree is thus always sorted 
+	and can be printed at any stage of its construction.
 	Actually, only a small subset of the containers is not handled due to forms like (A, B)*
 	where ordering should be specified at element construction. These containers are:
 		- credit
@@ -365,6 +536,18 @@ EXP TElement	factoryMeasureWithAttributes	(TFactory f, int number, const char* t
 */
 EXP TElement	factoryNote		(TFactory f, const char* step, float alter, int octave, int duration, const char* type);
 
+/*!
+	\brief Creates a set of notes and adds them to a measure.
+	\param f the MusicXML factory
+	\param measure the destination measure
+	\param notes an array of notes descriptions
+	\param count the notes count
+	\note: factoryAddNotes is equivalent to factoryNote or factoryRest followed by factoryAddElement
+	for each note, but saves the intermediate calls and references. The chord flag adds a 'chord' element to the note,
+	the tie flags create the corresponding tie and tied elements.
+*/
+EXP void		factoryAddNotes	(TFactory f, TElement measure, const TNote* notes, int count);
+
 /*!
 	\brief Creates a dynamics element containing a dynamic \c type.
 	\param f the MusicXML factory
@@ -423,7 +606,7 @@ EXP void		factoryNotation	(TFactory f, TElement elt, TElement notation);
 EXP void		factoryArticulation	(TFactory f, TElement elt, TElement articulation);
 
 /*!
-	\brief Creates a rest.
+	\brief Creates a rest: a note element including a rest element.
 	\param f the MusicXML factory
 	\param duration the sounding duration (in divisions count) (0 prevents the duration element creation)
 	\param type the graphic note type; in 256th, 128th, 64th, 32nd, 16th, eighth, quarter, half, whole, breve or long
@@ -519,3 +702,5 @@ EXP void		factoryFreeAttribute	(TFactory f, TAttribute attr);
 #endif
 
 }
+
+#endif
@@ -15,6 +15,8 @@
 #endif
 
 #include <iostream>
+#include <sstream>
+#include "doccache.h"
 #include "libmusicxml.h"
 #include "xml.h"
 #include "xmlfile.h"
@@ -32,7 +34,6 @@ static xmlErr xml2guido(SXMLFile& xmlfile, bool generateBars, ostream& out, cons
 	Sxmlelement st = xmlfile->elements();
 	if (st) {
 		xml2guidovisitor v(true, true, generateBars);
-		Sguidoelement gmn = v.convert(st);
 		if (file) {
 			out << "(*\n  gmn code converted from '" << file << "'"
 				<< "\n  using libmusicxml v." << musicxmllibVersionStr();
@@ -40,15 +41,36 @@ static xmlErr xml2guido(SXMLFile& xmlfile, bool generateBars, ostream& out, cons
 		else out << "(*\n  gmn code converted using libmusicxml v." << musicxmllibVersionStr();
 		out << "\n  and the embedded xml2guido converter v." << musicxml2guidoVersionStr()
 			<< "\n*)" << endl;
-		out << gmn << endl;
+		v.convert(st, out);
+		out << endl;
 		return kNoErr;
 	}
 	return kInvalidFile;
 }
 
+// the conversion to a string, used by the documents cache
+static xmlErr xml2guido(SXMLFile& xmlfile, bool generateBars, string& out, const char* file) 
+{
+	ostringstream buffer;
+	xmlErr err = xml2guido(xmlfile, generateBars, buffer, file);
+	out = buffer.str();
+	return err;
+}
+
+static xmlErr write(xmlErr err, const string& buffer, ostream& out) 
+{
+	if (err == kNoErr)
+		out.write (buffer.data(), buffer.size());
+	return err;
+}
+
 //_______________________________________________________________________________
 EXP xmlErr musicxmlfile2guido(const char *file, bool generateBars, ostream& out) 
 {
+	if (doccache::enabled()) {
+		string buffer;			// the cached conversions are not streamed
+		return write (doccache::convertfile (file, "guido", xml2guido, generateBars, buffer), buffer, out);
+	}
 	xmlreader r;
 	SXMLFile xmlfile;
 	xmlfile = r.read(file);
@@ -73,6 +95,10 @@ EXP xmlErr musicxmlfd2guido(FILE * fd, bool generateBars, ostream& out)
 //_______________________________________________________________________________
 EXP xmlErr musicxmlstring2guido(const char * buffer, bool generateBars, ostream& out) 
 {
+	if (doccache::enabled()) {
+		string gmn;
+		return write (doccache::convertbuff (buffer, "guido", xml2guido, generateBars, gmn), gmn, out);
+	}
 	xmlreader r;
 	SXMLFile xmlfile;
 	xmlfile = r.readbuff(buffer);
@@ -0,0 +1,80 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <iostream>
+#include "libmusicxml.h"
+#include "xml.h"
+#include "xmlfile.h"
+#include "xmlreader.h"
+#include "midirenderer.h"
+#include "smfwriter.h"
+
+using namespace std;
+
+namespace MusicXML2 
+{
+
+//_______________________________________________________________________________
+static xmlErr xml2midi(SXMLFile& xmlfile, int tpq, ostream& out) 
+{
+	Sxmlelement st = xmlfile->elements();
+	if (st && (tpq > 0)) {
+		smfwriter w(tpq);
+		midirenderer r(tpq);
+		r.render (st, &w);			// parts are rendered concurrently
+		w.write (out);
+		return out.good() ? kNoErr : kInvalidFile;
+	}
+	return kInvalidFile;
+}
+
+//_______________________________________________________________________________
+EXP xmlErr musicxmlfile2midi(const char *file, int tpq, ostream& out) 
+{
+	xmlreader r;
+	SXMLFile xmlfile;
+	xmlfile = r.read(file);
+	if (xmlfile) {
+		return xml2midi(xmlfile, tpq, out);
+	}
+	return kInvalidFile;
+}
+
+//_______________________________________________________________________________
+EXP xmlErr musicxmlfd2midi(FILE * fd, int tpq, ostream& out) 
+{
+	xmlreader r;
+	SXMLFile xmlfile;
+	xmlfile = r.read(fd);
+	if (xmlfile) {
+		return xml2midi(xmlfile, tpq, out);
+	}
+	return kInvalidFile;
+}
+
+//_______________________________________________________________________________
+EXP xmlErr musicxmlstring2midi(const char * buffer, int tpq, ostream& out) 
+{
+	xmlreader r;
+	SXMLFile xmlfile;
+	xmlfile = r.readbuff(buffer);
+	if (xmlfile) {
+		return xml2midi(xmlfile, tpq, out);
+	}
+	return kInvalidFile;
+}
+
+}
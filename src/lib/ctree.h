@@ -90,7 +90,9 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 		//________________________________________________________________________
 		treeIterator& erase() {
 			T parent = getParent();
+			T elt = *fCurrentIterator;
 			fCurrentIterator = parent->elements().erase(fCurrentIterator);
+			parent->release(elt);
 			if (fStack.size()) fStack.pop();
 			if (fCurrentIterator != parent->elements().end()) {
 				fStack.push( make_pair(fCurrentIterator+1, parent));
@@ -103,6 +105,7 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 		treeIterator& insert(const T& value) {
 			T parent = getParent();
 			fCurrentIterator = parent->elements().insert(fCurrentIterator, value);
+			parent->adopt(value);
 			if (fStack.size()) fStack.pop();
 			fStack.push( make_pair(fCurrentIterator+1, parent));
 			return *this;
@@ -132,7 +135,7 @@ template <typename T> class EXP ctree : virtual public smartable
 		
 		branchs& elements()						{ return fElements; }		
 		const branchs& elements() const			{ return fElements; }		
-		virtual void push (const treePtr& t)	{ fElements.push_back(t); }
+		virtual void push (const treePtr& t)	{ fElements.push_back(t); adopt(t); }
 		virtual int  size  () const				{ return int(fElements.size()); }
 		virtual bool empty () const				{ return fElements.size()==0; }
 
@@ -144,12 +147,29 @@ template <typename T> class EXP ctree : virtual public smartable
 		literator lbegin() { return fElements.begin(); }
 		literator lend()   { return fElements.end(); }
 
+		//! the node the node has been last attached to, null when none or when that node has been deleted
+		T*	 parent () const			{ return static_cast<T*>(fParent); }
+		//! sets the parent of a sub-element, to be called when elements() is modified directly
+		void adopt (const treePtr& t)	{ attached(t); t->fParent = this; }
+		//! clears the parent of a removed sub-element, to be called when elements() is modified directly
+		void release (const treePtr& t)	{ if (t->fParent == this) t->fParent = 0; detached(t); }
+
+		//! called when a sub-element is pushed or inserted, before its parent is set, does nothing by default
+		virtual void attached (const treePtr& t)	{}
+		//! called when a sub-element is erased, does nothing by default
+		virtual void detached (const treePtr& t)	{}
+
 	protected:
-				 ctree() {}
-		virtual ~ctree() {}
+				 ctree() : fParent(0) {}
+		virtual ~ctree() {
+			// the sub-elements may survive the node
+			for (typename branchs::iterator i = fElements.begin(); i != fElements.end(); i++)
+				if ((*i)->fParent == this) (*i)->fParent = 0;
+		}
 
 	private:
 		branchs	 fElements;
+		ctree*	 fParent;			///< a weak reference, cleared by the parent destructor
 };
 
 
@@ -0,0 +1,146 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <string.h>
+
+#include "profiler.h"
+
+#ifdef MUSICXMLPROFILING
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <mutex>
+# include <vector>
+#endif
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+#ifdef MUSICXMLPROFILING
+
+//______________________________________________________________________________
+// a thread record: the values are written by the owner thread only, they are
+// atomic for the snapshots to read them from other threads
+//______________________________________________________________________________
+typedef struct record {
+	atomic<unsigned long long>	fTime[kPhasesCount];		// in nanoseconds
+	atomic<unsigned long>		fCalls[kPhasesCount];
+	atomic<unsigned long>		fCounters[kCountersCount];
+	int							fDepth[kPhasesCount];		// the phases nesting, owner thread only
+
+	record()	{ clear(); for (int i = 0; i < kPhasesCount; i++) fDepth[i] = 0; }
+	void clear() {
+		for (int i = 0; i < kPhasesCount; i++) { fTime[i] = 0; fCalls[i] = 0; }
+		for (int i = 0; i < kCountersCount; i++) fCounters[i] = 0;
+	}
+	void addto (TProfile& p) const {
+		for (int i = 0; i < kPhasesCount; i++) {
+			p.time[i] += fTime[i].load(memory_order_relaxed) / 1e9;
+			p.calls[i] += fCalls[i].load(memory_order_relaxed);
+		}
+		for (int i = 0; i < kCountersCount; i++)
+			p.counters[i] += fCounters[i].load(memory_order_relaxed);
+	}
+} record;
+
+// a relaxed increment: there is a single writer
+template <typename T> static inline void add (atomic<T>& v, T n)	{ v.store (v.load(memory_order_relaxed) + n, memory_order_relaxed); }
+
+static mutex			gLock;
+static vector<record*>	gRecords;		// the running threads records
+static TProfile			gRetired;		// the values of the terminated threads
+
+//______________________________________________________________________________
+// registers the thread record on creation and retires it on the thread exit
+class recordholder {
+	public:
+		record fRecord;
+
+		 recordholder() {
+			lock_guard<mutex> lock (gLock);
+			gRecords.push_back (&fRecord);
+		 }
+		~recordholder() {
+			lock_guard<mutex> lock (gLock);
+			fRecord.addto (gRetired);
+			gRecords.erase (find (gRecords.begin(), gRecords.end(), &fRecord));
+		}
+};
+
+static record& local ()
+{
+	static thread_local recordholder holder;
+	return holder.fRecord;
+}
+
+//______________________________________________________________________________
+// profiler
+//______________________________________________________________________________
+void profiler::count (int counter, unsigned long n)	{ add (local().fCounters[counter], n); }
+
+bool profiler::enter (int phase)
+{
+	return local().fDepth[phase]++ == 0;
+}
+
+void profiler::leave (int phase, unsigned long long time)
+{
+	record& r = local();
+	r.fDepth[phase] = 0;
+	add (r.fTime[phase], time);
+	add (r.fCalls[phase], 1UL);
+}
+
+unsigned long long profiler::now ()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void profiler::snapshot (TProfile& profile)
+{
+	lock_guard<mutex> lock (gLock);
+	profile = gRetired;
+	for (vector<record*>::const_iterator i = gRecords.begin(); i != gRecords.end(); i++)
+		(*i)->addto (profile);
+}
+
+// the records of the running threads are cleared while they may be updated:
+// a reset during a conversion is approximate
+void profiler::reset ()
+{
+	lock_guard<mutex> lock (gLock);
+	memset (&gRetired, 0, sizeof(gRetired));
+	for (vector<record*>::const_iterator i = gRecords.begin(); i != gRecords.end(); i++)
+		(*i)->clear();
+}
+
+#else
+
+//______________________________________________________________________________
+// the instrumentation is disabled
+//______________________________________________________________________________
+void profiler::count (int counter, unsigned long n)		{}
+bool profiler::enter (int phase)						{ return false; }
+void profiler::leave (int phase, unsigned long long time)	{}
+unsigned long long profiler::now ()						{ return 0; }
+void profiler::snapshot (TProfile& profile)				{ memset (&profile, 0, sizeof(profile)); }
+void profiler::reset ()									{}
+
+#endif
+
+}
@@ -0,0 +1,82 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __profiler__
+#define __profiler__
+
+#include "exports.h"
+#include "libmusicxml.h"
+
+#ifdef MUSICXMLPROFILING
+# if !((__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1800)))
+#  error "the instrumentation (MUSICXMLPROFILING) requires C++11"
+# endif
+#endif
+
+namespace MusicXML2
+{
+
+/*!
+\internal
+\brief The instrumentation support.
+
+	Each thread accumulates its phases and counters in its own record: the
+	instrumentation doesn't lock nor share cache lines. A snapshot sums the
+	records of the running threads and of the terminated ones.
+
+	The PROFILE_PHASE and PROFILE_COUNT macros expand to nothing when the
+	library is compiled without MUSICXMLPROFILING. The macros must not be used
+	in the headers compiled by the library clients: these call the profiler
+	functions, which do nothing when the library is compiled without profiling.
+*/
+class EXP profiler
+{
+	public:
+		//! adds n to a counter of the current thread
+		static void		count (int counter, unsigned long n);
+		//! enters a phase, returns false when the phase is already entered by the current thread
+		static bool		enter (int phase);
+		//! leaves a phase, the time is given in nanoseconds
+		static void		leave (int phase, unsigned long long time);
+		static unsigned long long	now ();
+
+		static void		snapshot (TProfile& profile);
+		static void		reset ();
+};
+
+//______________________________________________________________________________
+/*!
+\internal
+\brief A scoped phase timer: a nested entry in the same phase is not counted.
+*/
+class EXP phasetimer
+{
+	int		fPhase;
+	bool	fActive;
+	unsigned long long	fStart;
+
+	public:
+				 phasetimer (int phase) : fPhase(phase), fActive(profiler::enter(phase)), fStart(fActive ? profiler::now() : 0) {}
+		virtual ~phasetimer()	{ if (fActive) profiler::leave (fPhase, profiler::now() - fStart); }
+};
+
+#ifdef MUSICXMLPROFILING
+# define PROFILE_PHASE(phase)		MusicXML2::phasetimer profilephasetimer(phase)
+# define PROFILE_COUNT(counter, n)	MusicXML2::profiler::count(counter, n)
+#else
+# define PROFILE_PHASE(phase)
+# define PROFILE_COUNT(counter, n)
+#endif
+
+}
+
+#endif
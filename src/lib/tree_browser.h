@@ -17,6 +17,7 @@
 #include "basevisitor.h"
 #include "browser.h"
 #include "ctree.h"
+#include "profiler.h"
 
 namespace MusicXML2 
 {
@@ -27,8 +28,10 @@ template <typename T> class EXP tree_browser : public browser<T>
 	protected:
 		basevisitor*	fVisitor;
 
-		virtual void enter (T& t)		{ t.acceptIn(*fVisitor); }
-		virtual void leave (T& t)		{ t.acceptOut(*fVisitor); }
+		// the template is compiled by the library clients: the count is a library call,
+		// enabled by the library MUSICXMLPROFILING setting and not by the client one
+		virtual void enter (T& t)		{ profiler::count(kVisitorCallbacks, 1); t.acceptIn(*fVisitor); }
+		virtual void leave (T& t)		{ profiler::count(kVisitorCallbacks, 1); t.acceptOut(*fVisitor); }
 
 	public:
 		typedef typename ctree<T>::treePtr treePtr;
@@ -0,0 +1,109 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#if (__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1800))
+# define PARALLELRENDERING
+# include <atomic>
+# include <thread>
+#endif
+
+#include "midirenderer.h"
+#include "profiler.h"
+#include "unrolled_xml_tree_browser.h"
+#include "xml_tree_browser.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// midibuffer
+//______________________________________________________________________________
+void midibuffer::replay (midiwriter* w) const
+{
+	for (vector<event>::const_iterator i = fEvents.begin(); i != fEvents.end(); i++) {
+		switch (i->fType) {
+			case kStartPart:	w->startPart (i->fValue); break;
+			case kInstrument:	w->newInstrument (fNames[i->fValue], i->fChan); break;
+			case kEndPart:		w->endPart (i->fDate); break;
+			case kNote:			w->newNote (i->fDate, i->fChan, i->fPitch, i->fValue, i->fDuration); break;
+			case kTempo:		w->tempoChange (i->fDate, i->fValue); break;
+			case kPedal:		w->pedalChange (i->fDate, midiwriter::pedalType(i->fChan), i->fValue); break;
+			case kVol:			w->volChange (i->fDate, i->fChan, i->fValue); break;
+			case kBank:			w->bankChange (i->fDate, i->fChan, i->fValue); break;
+			case kProg:			w->progChange (i->fDate, i->fChan, i->fValue); break;
+		}
+	}
+}
+
+//______________________________________________________________________________
+// midirenderer
+//______________________________________________________________________________
+void midirenderer::renderPart (const midicontextvisitor& context, int index)
+{
+	midicontextvisitor v (context, &fBuffers[index]);
+	unrolled_xml_tree_browser browser(&v);
+	browser.browse (*fParts[index]);
+}
+
+//______________________________________________________________________________
+void midirenderer::render (const Sxmlelement& score, midiwriter* writer, int threads)
+{
+	PROFILE_PHASE(kMidiPhase);
+	fParts.clear();
+
+	// the header context is built first, parts are collected for the next step
+	midicontextvisitor context (fTPQ, 0);
+	xml_tree_browser browser(&context);
+	for (ctree<xmlelement>::literator i = score->lbegin(); i != score->lend(); i++) {
+		if ((*i)->getType() == k_part) fParts.push_back (*i);
+		else browser.browse (**i);
+	}
+
+	fBuffers.clear();
+	fBuffers.resize (fParts.size());
+	int count = int(fParts.size());
+
+#ifdef PARALLELRENDERING
+	if (threads <= 0) threads = thread::hardware_concurrency();
+	if (threads > count) threads = count;
+	if (threads > 1) {
+		atomic<int> next (0);
+		vector<thread> workers;
+		for (int i = 0; i < threads; i++) {
+			workers.push_back (thread ([this, &context, &next, count] () {
+				for (int index = next++; index < count; index = next++)
+					renderPart (context, index);
+			}));
+		}
+		for (vector<thread>::iterator i = workers.begin(); i != workers.end(); i++)
+			i->join();
+	}
+	else
+#endif
+	for (int i = 0; i < count; i++)
+		renderPart (context, i);
+
+	if (writer) {
+		for (vector<midibuffer>::const_iterator i = fBuffers.begin(); i != fBuffers.end(); i++)
+			i->replay (writer);
+	}
+	fBuffers.clear();
+	fParts.clear();
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __midirenderer__
+#define __midirenderer__
+
+#include <string>
+#include <vector>
+
+#include "exports.h"
+#include "midicontextvisitor.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup midi
+@{
+*/
+
+//______________________________________________________________________________
+/*!
+\brief A midiwriter that stores the events in memory.
+
+	The events can be sent later to another writer, in the order they have been received.
+*/
+class EXP midibuffer : public midiwriter
+{
+	public:
+				 midibuffer() {}
+		virtual ~midibuffer() {}
+
+		virtual void startPart (int instrCount)							{ add (kStartPart, 0, -1, 0, instrCount); }
+		virtual void newInstrument (std::string instrName, int chan=-1)	{ add (kInstrument, 0, chan, 0, int(fNames.size())); fNames.push_back(instrName); }
+		virtual void endPart (long date)								{ add (kEndPart, date); }
+
+		virtual void newNote (long date, int chan, float pitch, int velocity, int duration)
+																		{ add (kNote, date, chan, pitch, velocity, duration); }
+		virtual void tempoChange (long date, int bpm)					{ add (kTempo, date, -1, 0, bpm); }
+		virtual void pedalChange (long date, pedalType t, int value)	{ add (kPedal, date, t, 0, value); }
+
+		virtual void volChange (long date, int chan, int vol)			{ add (kVol, date, chan, 0, vol); }
+		virtual void bankChange (long date, int chan, int bank)			{ add (kBank, date, chan, 0, bank); }
+		virtual void progChange (long date, int chan, int prog)			{ add (kProg, date, chan, 0, prog); }
+
+		//! sends the stored events to a writer
+		void	replay (midiwriter* w) const;
+		void	clear ()			{ fEvents.clear(); fNames.clear(); }
+		int		size () const		{ return int(fEvents.size()); }
+
+	private:
+		enum { kStartPart, kInstrument, kEndPart, kNote, kTempo, kPedal, kVol, kBank, kProg };
+		typedef struct {
+			int		fType;
+			long	fDate;
+			int		fChan;		///< the MIDI channel or the pedal type
+			float	fPitch;
+			int		fValue;		///< velocity, bpm, pedal, volume, bank, program or instrument name index
+			int		fDuration;
+		} event;
+
+		std::vector<event>			fEvents;
+		std::vector<std::string>	fNames;
+
+		void add (int type, long date, int chan=-1, float pitch=0, int value=0, int dur=0) {
+			event e = { type, date, chan, pitch, value, dur };
+			fEvents.push_back (e);
+		}
+};
+
+//______________________________________________________________________________
+/*!
+\brief Renders the parts of a score to MIDI concurrently.
+
+	Parts share only the score header (the part-list with the instruments definitions),
+	which is visited once to build the initial context. Next, each part is rendered on
+	its own worker, using its own midicontextvisitor initialized with this context and
+	writing to its own midibuffer. Finally, the buffers are sent to the destination
+	writer in the parts order, the output is thus the same as a serial rendering
+	where each part starts with the header context.
+
+	The score is unrolled (see unrolled_xml_tree_browser). Since the parts are disjoint
+	subtrees, the workers never share an element.
+	Parallel rendering requires C++11 support, otherwise the parts are rendered serially.
+*/
+class EXP midirenderer
+{
+	public:
+				 midirenderer(long tpq) : fTPQ(tpq) {}
+		virtual ~midirenderer() {}
+
+		/*! renders a score to a midi writer
+			\param score a partwise score
+			\param writer the destination writer
+			\param threads the maximum number of workers, 0 to use the hardware concurrency
+		*/
+		void	render (const Sxmlelement& score, midiwriter* writer, int threads=0);
+
+	private:
+		long						fTPQ;
+		std::vector<Sxmlelement>	fParts;
+		std::vector<midibuffer>		fBuffers;
+
+		void	renderPart (const midicontextvisitor& context, int index);
+};
+
+/*! @} */
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <algorithm>
+#include <fstream>
+
+#include "smfwriter.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+#define kPercussionChan	9
+
+static inline int clip (int val, int min, int max)	{ return (val < min) ? min : (val > max) ? max : val; }
+
+//______________________________________________________________________________
+// encoding utilities
+//______________________________________________________________________________
+static void writeVLQ (string& out, unsigned long val)
+{
+	unsigned char buff[5];
+	int n = 0;
+	buff[n++] = val & 0x7f;
+	while (val >>= 7)
+		buff[n++] = (val & 0x7f) | 0x80;
+	while (n--) out += char(buff[n]);
+}
+
+static void write32 (string& out, unsigned long val)
+{
+	out += char((val >> 24) & 0xff);
+	out += char((val >> 16) & 0xff);
+	out += char((val >> 8) & 0xff);
+	out += char(val & 0xff);
+}
+
+static void write16 (string& out, unsigned int val)
+{
+	out += char((val >> 8) & 0xff);
+	out += char(val & 0xff);
+}
+
+//______________________________________________________________________________
+static bool before (const smfwriter::event& e1, const smfwriter::event& e2)
+{
+	if (e1.fDate == e2.fDate) return e1.fOrder < e2.fOrder;
+	return e1.fDate < e2.fDate;
+}
+
+//______________________________________________________________________________
+// smfwriter
+//______________________________________________________________________________
+smfwriter::smfwriter(int tpq) : fTPQ(tpq)
+{
+	clear();
+}
+
+void smfwriter::clear ()
+{
+	fNextChan = 0;
+	fTracks.clear();
+	fTracks.push_back (track());		// the tempo track
+	fTracks.back().fChan = 0;
+	fTracks.back().fEnd = 0;
+}
+
+//______________________________________________________________________________
+smfwriter::track& smfwriter::current ()	{ return fTracks.back(); }
+
+int smfwriter::channel (int chan)
+{
+	// MusicXML channels are in 1-16
+	return ((chan > 0) && (chan <= 16)) ? chan - 1 : current().fChan;
+}
+
+//______________________________________________________________________________
+void smfwriter::add (track& t, long date, int order, int status, int data1, int data2)
+{
+	event e;
+	e.fDate = (date < 0) ? 0 : date;
+	e.fOrder = order;
+	e.fData[0] = status;
+	e.fData[1] = data1;
+	e.fData[2] = (data2 < 0) ? 0 : data2;
+	e.fLen = (data2 < 0) ? 1 : 2;
+	e.fText = 0;
+	t.fEvents.push_back (e);
+	if (t.fEnd < e.fDate) t.fEnd = e.fDate;
+}
+
+void smfwriter::meta (track& t, long date, int type, const string& data)
+{
+	event e;
+	e.fDate = (date < 0) ? 0 : date;
+	e.fOrder = kMetaOrder;
+	e.fData[0] = 0xff;
+	e.fData[1] = type;
+	e.fData[2] = 0;
+	e.fLen = (unsigned short)min(data.size(), size_t(0xffff));
+	e.fText = (unsigned int)t.fText.size();
+	t.fText.append (data, 0, e.fLen);
+	t.fEvents.push_back (e);
+	if (t.fEnd < e.fDate) t.fEnd = e.fDate;
+}
+
+//______________________________________________________________________________
+// midiwriter interface
+//______________________________________________________________________________
+void smfwriter::startPart (int instrCount)
+{
+	fTracks.push_back (track());
+	track& t = current();
+	if (fNextChan == kPercussionChan) fNextChan++;
+	t.fChan = fNextChan % 16;
+	t.fEnd = 0;
+	fNextChan = (fNextChan + 1) % 16;
+	t.fEvents.reserve (256);
+}
+
+void smfwriter::newInstrument (std::string instrName, int chan)
+{
+	track& t = current();
+	if (t.fEvents.empty()) {			// first instrument: also gives its name to the track
+		meta (t, 0, 0x03, instrName);
+		if ((chan > 0) && (chan <= 16)) t.fChan = chan - 1;
+	}
+	meta (t, 0, 0x04, instrName);
+}
+
+void smfwriter::endPart (long date)
+{
+	track& t = current();
+	if (t.fEnd < date) t.fEnd = date;
+}
+
+//______________________________________________________________________________
+void smfwriter::newNote (long date, int chan, float pitch, int velocity, int duration)
+{
+	if (velocity <= 0) return;
+	track& t = current();
+	int c = channel (chan);
+	int p = clip (int(pitch + 0.5f), 0, 127);
+	add (t, date, kNoteOnOrder, 0x90 | c, p, clip (velocity, 1, 127));
+	add (t, date + ((duration < 0) ? 0 : duration), kNoteOffOrder, 0x80 | c, p, 0);
+}
+
+void smfwriter::tempoChange (long date, int bpm)
+{
+	if (bpm <= 0) return;
+	unsigned long usec = 60000000UL / bpm;
+	string data;
+	data += char((usec >> 16) & 0xff);
+	data += char((usec >> 8) & 0xff);
+	data += char(usec & 0xff);
+	meta (fTracks.front(), date, 0x51, data);
+}
+
+void smfwriter::pedalChange (long date, pedalType type, int value)
+{
+	int ctrl = 64;
+	switch (type) {
+		case kDamperPedal:		ctrl = 64; break;
+		case kSoftpedal:		ctrl = 67; break;
+		case kSostenutoPedal:	ctrl = 66; break;
+	}
+	add (current(), date, kCtrlOrder, 0xb0 | current().fChan, ctrl, clip (value, 0, 127));
+}
+
+void smfwriter::volChange (long date, int chan, int vol)
+{
+	add (current(), date, kCtrlOrder, 0xb0 | channel(chan), 7, clip ((vol * 127) / 100, 0, 127));
+}
+
+void smfwriter::bankChange (long date, int chan, int bank)
+{
+	int b = clip (bank - 1, 0, 16383);
+	int c = channel(chan);
+	add (current(), date, kCtrlOrder, 0xb0 | c, 0, b >> 7);
+	add (current(), date, kCtrlOrder, 0xb0 | c, 32, b & 0x7f);
+}
+
+void smfwriter::progChange (long date, int chan, int prog)
+{
+	add (current(), date, kCtrlOrder, 0xc0 | channel(chan), clip (prog - 1, 0, 127));
+}
+
+//______________________________________________________________________________
+// file generation
+//______________________________________________________________________________
+void smfwriter::encode (track& t, string& out) const
+{
+	stable_sort (t.fEvents.begin(), t.fEvents.end(), before);
+
+	out.clear();
+	out.reserve (t.fEvents.size() * 4 + t.fText.size() + 16);
+	out += "MTrk";
+	write32 (out, 0);					// length is set at the end
+
+	long last = 0;
+	int status = 0;						// running status
+	const event* prev = 0;
+	for (vector<event>::const_iterator i = t.fEvents.begin(); i != t.fEvents.end(); i++) {
+		const event& e = *i;
+		if (e.fData[0] == 0xff) {
+			// skip redundant meta events (e.g. the same tempo change sent by several parts)
+			if (prev && (prev->fData[0] == 0xff) && (prev->fDate == e.fDate) && (prev->fData[1] == e.fData[1])
+				&& !t.fText.compare (prev->fText, prev->fLen, t.fText, e.fText, e.fLen))
+				continue;
+			writeVLQ (out, e.fDate - last);
+			out += char(0xff);
+			out += char(e.fData[1]);
+			writeVLQ (out, e.fLen);
+			out.append (t.fText, e.fText, e.fLen);
+			status = 0;
+		}
+		else {
+			writeVLQ (out, e.fDate - last);
+			if (e.fData[0] != status) {
+				status = e.fData[0];
+				out += char(status);
+			}
+			out.append ((const char*)&e.fData[1], e.fLen);
+		}
+		last = e.fDate;
+		prev = &e;
+	}
+	writeVLQ (out, (t.fEnd > last) ? t.fEnd - last : 0);
+	out += char(0xff);
+	out += char(0x2f);
+	out += char(0);
+
+	unsigned long len = out.size() - 8;
+	for (int i = 0; i < 4; i++)
+		out[7-i] = char((len >> (i*8)) & 0xff);
+}
+
+//______________________________________________________________________________
+void smfwriter::write (ostream& out)
+{
+	long end = 0;
+	for (vector<track>::const_iterator i = fTracks.begin(); i != fTracks.end(); i++)
+		if (i->fEnd > end) end = i->fEnd;
+	fTracks.front().fEnd = end;
+
+	string buffer = "MThd";
+	write32 (buffer, 6);
+	write16 (buffer, 1);				// format 1
+	write16 (buffer, int(fTracks.size()));
+	write16 (buffer, fTPQ);
+	out.write (buffer.data(), buffer.size());
+
+	for (vector<track>::iterator i = fTracks.begin(); i != fTracks.end(); i++) {
+		encode (*i, buffer);
+		out.write (buffer.data(), buffer.size());
+	}
+}
+
+//______________________________________________________________________________
+bool smfwriter::write (const char* file)
+{
+	ofstream out (file, ios::out | ios::binary);
+	if (!out.is_open()) return false;
+	write (out);
+	return out.good();
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __smfwriter__
+#define __smfwriter__
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "exports.h"
+#include "midicontextvisitor.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup midi
+@{
+*/
+
+//______________________________________________________________________________
+/*!
+\brief A midiwriter that generates a Standard MIDI File (type 1).
+
+	Events are collected per track in flat arrays and sorted only once, when the
+	file is written. The first track is the tempo track, the next ones correspond
+	to the score parts. Each track is encoded into a memory buffer that is written
+	to the output stream with a single write.
+
+	MIDI channels of the midiwriter interface are expected in the MusicXML range
+	(1 to 16), MIDI programs and banks as well (starting at 1). When no channel is
+	specified, each part is assigned a channel, the percussion channel excepted.
+*/
+class EXP smfwriter : public midiwriter
+{
+	public:
+		typedef struct {
+			long			fDate;		///< the event date in ticks
+			unsigned short	fOrder;		///< the event rank at a given date
+			unsigned char	fData[3];	///< status and data bytes or meta type and 0
+			unsigned short	fLen;		///< the data length (MIDI events) or the meta data length
+			unsigned int	fText;		///< the meta data offset in the track text buffer
+		} event;
+
+		typedef struct {
+			std::vector<event>	fEvents;
+			std::string			fText;		///< meta events data
+			int					fChan;		///< the track default MIDI channel
+			long				fEnd;		///< the track end date
+		} track;
+
+				 smfwriter(int tpq=480);
+		virtual ~smfwriter() {}
+
+		virtual void startPart (int instrCount);
+		virtual void newInstrument (std::string instrName, int chan=-1);
+		virtual void endPart (long date);
+
+		virtual void newNote (long date, int chan, float pitch, int velocity, int duration);
+		virtual void tempoChange (long date, int bpm);
+		virtual void pedalChange (long date, pedalType t, int value);
+
+		virtual void volChange (long date, int chan, int vol);
+		virtual void bankChange (long date, int chan, int bank);
+		virtual void progChange (long date, int chan, int prog);
+
+		//! writes the MIDI file to a stream (that should be opened in binary mode)
+		void	write (std::ostream& out);
+		//! writes the MIDI file to a file
+		bool	write (const char* file);
+		//! clears the collected events
+		void	clear ();
+
+		int		tracks () const		{ return int(fTracks.size()); }
+
+	private:
+		enum { kMetaOrder, kNoteOffOrder, kCtrlOrder, kNoteOnOrder };
+
+		int					fTPQ;
+		int					fNextChan;	///< the next default MIDI channel
+		std::vector<track>	fTracks;	///< the tempo track followed by the parts tracks
+
+		track&	current ();
+		int		channel (int chan);
+		void	add (track& t, long date, int order, int status, int data1, int data2=-1);
+		void	meta (track& t, long date, int type, const std::string& data);
+		void	encode (track& t, std::string& out) const;
+};
+
+/*! @} */
+
+}
+
+#endif
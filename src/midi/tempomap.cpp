@@ -0,0 +1,260 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "metronomevisitor.h"
+#include "midicontextvisitor.h"
+#include "tempomap.h"
+#include "unrolled_xml_tree_browser.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+#define kDefaultTempo	120.
+
+//______________________________________________________________________________
+// a visitor that collects the tempo changes and the measures dates
+//______________________________________________________________________________
+class tempomapvisitor :
+	public midicontextvisitor,
+	public metronomevisitor
+{
+	public:
+		typedef struct { long fTick; double fTempo; bool fSound; } change;
+
+		std::vector<change>				fChanges;
+		std::vector<tempomap::measure>	fMeasures;
+
+				 tempomapvisitor(long tpq) : midicontextvisitor(tpq), fPart(0) {}
+		virtual ~tempomapvisitor() {}
+
+	protected:
+		int	fPart;
+
+		void add (double tempo, bool sound) {
+			if (tempo > 0) {
+				change c = { fCurrentDate, tempo, sound };
+				fChanges.push_back (c);
+			}
+		}
+
+		virtual void visitStart( S_part& elt )		{ fPart++; midicontextvisitor::visitStart(elt); }
+		virtual void visitStart( S_measure& elt ) {
+			if (fPart == 1) {				// measures dates are taken from the first part
+				tempomap::measure m = { fCurrentDate, elt->getAttributeValue("number") };
+				fMeasures.push_back (m);
+			}
+		}
+		virtual void visitStart( S_sound& elt ) {
+			midicontextvisitor::visitStart(elt);
+			Sxmlattribute tempo = elt->getAttribute("tempo");
+			if (tempo) add (float(*tempo), true);
+		}
+		virtual void visitEnd( S_metronome& elt ) {
+			metronomevisitor::visitEnd(elt);
+			if ((fBeats.size() == 1) && fPerMinute)		// metric modulations are ignored
+				add (fPerMinute * quarters (fBeats[0]), false);
+		}
+
+		// gives a beat unit duration in quarter notes
+		static double quarters (const beat& b) {
+			const char* units[] = { "long", "breve", "whole", "half", "quarter", "eighth", "16th", "32nd", "64th", "128th", "256th", 0 };
+			double value = 16.;
+			for (int i = 0; units[i]; i++, value /= 2) {
+				if (b.fUnit == units[i]) {
+					double dur = value;
+					for (int d = 0; d < b.fDots; d++) dur += value / (2 << d);
+					return dur;
+				}
+			}
+			return 0;
+		}
+};
+
+static bool before (const tempomapvisitor::change& c1, const tempomapvisitor::change& c2)	{ return c1.fTick < c2.fTick; }
+
+//______________________________________________________________________________
+// tempomap
+//______________________________________________________________________________
+void tempomap::clear ()
+{
+	fTempi.clear();
+	fMeasures.clear();
+	fNumbers.clear();
+	add (0, kDefaultTempo);
+	update();
+}
+
+//______________________________________________________________________________
+void tempomap::build (const Sxmlelement& score)
+{
+	tempomapvisitor v (fTPQ);
+	unrolled_xml_tree_browser browser(&v);
+	browser.browse (*score);
+
+	fTempi.clear();
+	stable_sort (v.fChanges.begin(), v.fChanges.end(), before);
+	vector<tempomapvisitor::change>::const_iterator i = v.fChanges.begin();
+	while (i != v.fChanges.end()) {
+		// a sound tempo takes precedence over a metronome mark at the same date
+		const tempomapvisitor::change* selected = &(*i);
+		long tick = i->fTick;
+		for (; (i != v.fChanges.end()) && (i->fTick == tick); i++)
+			if (i->fSound || !selected->fSound) selected = &(*i);
+		add (tick, selected->fTempo);
+	}
+	if (fTempi.empty() || fTempi[0].fTick) fTempi.insert (fTempi.begin(), tempo());
+	fTempi[0].fTick = 0;
+	if (fTempi[0].fTempo <= 0) fTempi[0].fTempo = kDefaultTempo;
+	update();
+	fMeasures = v.fMeasures;
+	index();
+}
+
+//______________________________________________________________________________
+void tempomap::add (long tick, double bpm)
+{
+	if (fTempi.size() && (fTempi.back().fTempo == bpm)) return;		// redundant change
+	tempo t = { tick, 0, bpm };
+	if (fTempi.size() && (fTempi.back().fTick == tick)) fTempi.back() = t;
+	else fTempi.push_back (t);
+}
+
+//______________________________________________________________________________
+void tempomap::update ()
+{
+	double seconds = 0;
+	for (size_t i = 0; i < fTempi.size(); i++) {
+		if (i) seconds += (fTempi[i].fTick - fTempi[i-1].fTick) * 60. / (fTempi[i-1].fTempo * fTPQ);
+		fTempi[i].fSeconds = seconds;
+	}
+}
+
+//______________________________________________________________________________
+void tempomap::index ()
+{
+	fNumbers.clear();
+	for (size_t i = 0; i < fMeasures.size(); i++)
+		fNumbers.push_back (make_pair (fMeasures[i].fNumber, int(i)));
+	sort (fNumbers.begin(), fNumbers.end());		// the occurrences of a number are in the performance order
+}
+
+//______________________________________________________________________________
+static bool tickLess (long tick, const tempomap::tempo& t)				{ return tick < t.fTick; }
+static bool secondsLess (double sec, const tempomap::tempo& t)			{ return sec < t.fSeconds; }
+static bool measureLess (long tick, const tempomap::measure& m)		{ return tick < m.fTick; }
+
+const tempomap::tempo& tempomap::segment (long tick) const
+{
+	vector<tempo>::const_iterator i = upper_bound (fTempi.begin(), fTempi.end(), tick, tickLess);
+	return (i == fTempi.begin()) ? *i : *(i-1);
+}
+
+//______________________________________________________________________________
+double tempomap::seconds (long tick) const
+{
+	const tempo& t = segment (tick);
+	return t.fSeconds + (tick - t.fTick) * 60. / (t.fTempo * fTPQ);
+}
+
+long tempomap::ticks (double seconds) const
+{
+	vector<tempo>::const_iterator i = upper_bound (fTempi.begin(), fTempi.end(), seconds, secondsLess);
+	const tempo& t = (i == fTempi.begin()) ? *i : *(i-1);
+	return t.fTick + long((seconds - t.fSeconds) * t.fTempo * fTPQ / 60. + 0.5);
+}
+
+double tempomap::tempoAt (long tick) const		{ return segment(tick).fTempo; }
+
+//______________________________________________________________________________
+double tempomap::measureSeconds (int index) const
+{
+	if ((index < 0) || (index >= int(fMeasures.size()))) return -1;
+	return seconds (fMeasures[index].fTick);
+}
+
+int tempomap::measureAt (double seconds) const
+{
+	if ((seconds < 0) || fMeasures.empty()) return -1;
+	long tick = ticks (seconds);
+	vector<measure>::const_iterator i = upper_bound (fMeasures.begin(), fMeasures.end(), tick, measureLess);
+	return int(i - fMeasures.begin()) - 1;
+}
+
+int tempomap::find (const std::string& number, int occurrence) const
+{
+	if (occurrence < 0) return -1;
+	vector<pair<string, int> >::const_iterator i = lower_bound (fNumbers.begin(), fNumbers.end(), make_pair (number, -1));
+	if ((fNumbers.end() - i) <= occurrence) return -1;
+	i += occurrence;
+	return (i->first == number) ? i->second : -1;
+}
+
+//______________________________________________________________________________
+// serialization
+//______________________________________________________________________________
+void tempomap::write (ostream& out) const
+{
+	out << "tempomap " << fTPQ << "\n";
+	for (vector<tempo>::const_iterator i = fTempi.begin(); i != fTempi.end(); i++)
+		out << "t " << i->fTick << " " << setprecision(10) << i->fTempo << "\n";
+	for (vector<measure>::const_iterator i = fMeasures.begin(); i != fMeasures.end(); i++)
+		out << "m " << i->fTick << " " << i->fNumber << "\n";
+}
+
+bool tempomap::read (istream& in)
+{
+	string line, tag;
+	if (!getline (in, line)) return false;
+	istringstream header (line);
+	long tpq = 0;
+	if (!(header >> tag >> tpq) || (tag != "tempomap") || (tpq <= 0)) return false;
+
+	vector<tempo> tempi;
+	vector<measure> measures;
+	while (getline (in, line)) {
+		istringstream s (line);
+		long tick;
+		if (!(s >> tag >> tick)) continue;
+		if (tag == "t") {
+			tempo t = { tick, 0, 0 };
+			if (!(s >> t.fTempo) || (t.fTempo <= 0)) return false;
+			if (tempi.size() && (tick <= tempi.back().fTick)) return false;		// the lookups require sorted tables
+			tempi.push_back (t);
+		}
+		else if (tag == "m") {
+			measure m = { tick, "" };
+			s >> ws;
+			getline (s, m.fNumber);
+			if (measures.size() && (tick < measures.back().fTick)) return false;
+			measures.push_back (m);
+		}
+	}
+	if (tempi.empty() || tempi[0].fTick) return false;
+	fTPQ = tpq;
+	fTempi = tempi;
+	fMeasures = measures;
+	update();
+	index();
+	return true;
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __tempomap__
+#define __tempomap__
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exports.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup midi
+@{
+*/
+
+//______________________________________________________________________________
+/*!
+\brief A tempo map of a score, for real time positions lookup.
+
+	The map is built from the \b tempo attribute of the \b sound elements and from
+	the \b metronome elements (a \b sound tempo takes precedence over a metronome
+	mark at the same date), using the same time base as the midicontextvisitor.
+	The score is unrolled: measures are indexed in the performance order.
+
+	The map is a sorted piecewise linear table: converting between ticks and seconds,
+	or finding a measure from a date or from its number, are O(log n) lookups. The map can be written
+	to a stream and read back, e.g. to be stored with a document.
+*/
+class EXP tempomap
+{
+	public:
+		typedef struct {
+			long	fTick;		///< the tempo change date
+			double	fSeconds;	///< the tempo change date in seconds
+			double	fTempo;		///< the tempo in quarter notes per minute
+		} tempo;
+
+		typedef struct {
+			long		fTick;		///< the measure start date
+			std::string	fNumber;	///< the measure number attribute
+		} measure;
+
+				 tempomap(long tpq=480) : fTPQ(tpq) { clear(); }
+		virtual ~tempomap() {}
+
+		//! builds the map of a partwise score
+		void	build (const Sxmlelement& score);
+		void	clear ();
+
+		long	tpq () const				{ return fTPQ; }
+		const std::vector<tempo>&	tempi () const		{ return fTempi; }
+		const std::vector<measure>&	measures () const	{ return fMeasures; }
+
+		//! converts a date in ticks into seconds
+		double	seconds (long tick) const;
+		//! converts a date in seconds into ticks
+		long	ticks (double seconds) const;
+		//! gives the tempo (in quarter notes per minute) at a given date
+		double	tempoAt (long tick) const;
+
+		//! gives the start date in seconds of a measure, given its index in the performance order
+		double	measureSeconds (int index) const;
+		//! gives the index of the measure played at a given time, -1 when out of the score
+		int		measureAt (double seconds) const;
+		//! gives the index of the nth occurrence of a measure in the performance order, -1 when not found
+		int		find (const std::string& number, int occurrence=0) const;
+
+		//! writes the map in a text form
+		void	write (std::ostream& out) const;
+		//! reads a map previously written
+		bool	read (std::istream& in);
+
+	private:
+		long					fTPQ;
+		std::vector<tempo>		fTempi;			///< sorted by date, the first tempo is at date 0
+		std::vector<measure>	fMeasures;		///< sorted by date
+		std::vector<std::pair<std::string, int> >	fNumbers;	///< the measures numbers and indexes, sorted by number
+
+		void	add (long tick, double tempo);
+		void	update ();						///< computes the tempo changes dates in seconds
+		void	index ();						///< builds the measures numbers table
+		const tempo& segment (long tick) const;
+};
+
+/*! @} */
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include "batchtransposition.h"
+#include "factory.h"
+#include "xml_tree_browser.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//________________________________________________________________________
+batchtransposition::batchtransposition (const vector<int>& intervals)
+{
+	for (vector<int>::const_iterator i = intervals.begin(); i != intervals.end(); i++) {
+		target t;
+		t.fTransposer = new transposition (*i);
+		fTargets.push_back (t);
+	}
+}
+
+batchtransposition::~batchtransposition()
+{
+	for (vector<target>::iterator i = fTargets.begin(); i != fTargets.end(); i++)
+		delete i->fTransposer;
+}
+
+//________________________________________________________________________
+vector<Sxmlelement> batchtransposition::transpose (const Sxmlelement& score)
+{
+	vector<Sxmlelement> scores;
+	if (!score) return scores;
+
+	xml_tree_browser browser(this);
+	browser.browse (*score);
+	for (vector<target>::iterator i = fTargets.begin(); i != fTargets.end(); i++) {
+		scores.push_back (i->fScore);
+		i->fScore = (xmlelement*)0;
+	}
+	return scores;
+}
+
+//________________________________________________________________________
+// copies an element with its attributes, the copy has the same type than the source
+Sxmlelement batchtransposition::copy (const Sxmlelement& elt) const
+{
+	Sxmlelement copy = elt->getType() ? factory::instance().create(elt->getType()) : xmlelement::create();
+	if (!copy) copy = xmlelement::create();
+	copy->setName (elt->getName());
+	copy->setValue (elt->getValue());
+	const vector<Sxmlattribute>& attributes = elt->attributes();
+	for (vector<Sxmlattribute>::const_iterator i = attributes.begin(); i != attributes.end(); i++) {
+		Sxmlattribute attr = xmlattribute::create();
+		attr->setName ((*i)->getName());
+		attr->setValue ((*i)->getValue());
+		copy->add (attr);
+	}
+	return copy;
+}
+
+//________________________________________________________________________
+void batchtransposition::visitStart ( Sxmlelement& elt )
+{
+	for (vector<target>::iterator i = fTargets.begin(); i != fTargets.end(); i++) {
+		Sxmlelement c = copy (elt);
+		if (i->fStack.empty()) i->fScore = c;
+		else i->fStack.top()->push (c);
+		i->fStack.push (c);
+		c->acceptIn (*i->fTransposer);
+	}
+}
+
+//________________________________________________________________________
+void batchtransposition::visitEnd ( Sxmlelement& elt )
+{
+	for (vector<target>::iterator i = fTargets.begin(); i != fTargets.end(); i++) {
+		i->fStack.top()->acceptOut (*i->fTransposer);
+		i->fStack.pop();
+	}
+}
+
+}
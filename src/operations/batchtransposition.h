@@ -0,0 +1,74 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __batchtransposition__
+#define __batchtransposition__
+
+#include <stack>
+#include <vector>
+
+#include "exports.h"
+#include "transposition.h"
+#include "visitor.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup visitors
+@{
+*/
+
+/*!
+\brief A visitor that computes several transpositions of a score at once.
+
+	The source score is browsed once and left unchanged: each element is copied
+	into one destination tree per transposition interval, and each copy is sent
+	to the corresponding transposition visitor, as if the copies were browsed.
+	The result is thus the same as cloning and transposing the score for each
+	interval, without the N clone and transposition passes.
+*/
+class EXP batchtransposition :
+	public visitor<Sxmlelement>
+{
+	public:
+				 batchtransposition(const std::vector<int>& intervals);
+		virtual ~batchtransposition();
+
+		/*! transposes a score
+			\param score the source score (left unchanged)
+			\return the transposed scores, in the intervals order
+		*/
+		std::vector<Sxmlelement>	transpose (const Sxmlelement& score);
+
+		virtual void visitStart( Sxmlelement& elt );
+		virtual void visitEnd  ( Sxmlelement& elt );
+
+	protected:
+		typedef struct {
+			transposition*				fTransposer;
+			std::stack<Sxmlelement>		fStack;		///< the current copies path
+			Sxmlelement					fScore;		///< the destination score
+		} target;
+
+		std::vector<target>		fTargets;
+
+		Sxmlelement	copy (const Sxmlelement& elt) const;
+};
+
+/*! @} */
+
+} // namespace MusicXML2
+
+
+#endif
@@ -43,7 +43,6 @@ transposition::transposition (int steps)
 	fOctaveChange = getOctave(fChromaticSteps);
 	fTableShift = getKey (getOctaveStep(fChromaticSteps));
 	fKeySign = fCurrentKeySign = getKey(fChromaticSteps);
-	initialize();
 }
 
 transposition::~transposition() {}
@@ -57,19 +56,23 @@ transposition::~transposition() {}
 	A, E, B, F#, C#, G#, D#, A#, E#, B#, F##, C##, G##, D##, A##, E##, B##.
 	To apply transposition, we first look in the table for the correct
 	shifting, and apply the same to every note to transpose.
+	The table is constant: a note index is computed from its step position
+	in the fifths order (F C G D A E B) and from its alteration.
 */
-void transposition::initialize ()
+#define kFifthCycleSize		35
+#define kStepsCount			7
+#define kMaxAlter			2
+
+static const char* kFifthCycle[kStepsCount] = { "F", "C", "G", "D", "A", "E", "B" };
+// the steps positions in the fifths order, indexed by step letter (from A to G)
+static const int kStepFifth[kStepsCount] = { 4, 6, 1, 3, 5, 0, 2 };
+
+// gives the index of a note into the fifth cycle, -1 when out of the table
+static int fifthIndex (const string& step, int alter)
 {
-	fFifthCycle.clear();
-	for (int i=-2; i<=2; i++) {
-		fFifthCycle.push_back(make_pair("F", i));
-		fFifthCycle.push_back(make_pair("C", i));
-		fFifthCycle.push_back(make_pair("G", i));
-		fFifthCycle.push_back(make_pair("D", i));
-		fFifthCycle.push_back(make_pair("A", i));
-		fFifthCycle.push_back(make_pair("E", i));
-		fFifthCycle.push_back(make_pair("B", i));
-	}
+	if ((step.size() != 1) || (step[0] < 'A') || (step[0] > 'G')) return -1;
+	if ((alter < -kMaxAlter) || (alter > kMaxAlter)) return -1;
+	return (alter + kMaxAlter) * kStepsCount + kStepFifth[step[0] - 'A'];
 }
 
 //________________________________________________________________________
@@ -78,24 +81,23 @@ void transposition::transpose ( string& pitch, float& alter, int& octave, int ta
 {
 	int ialter = round(alter);
 	float diff = alter - ialter;
-	int pitch1 = notevisitor::step2i(pitch);
-	for (int i=0; i < fFifthCycle.size(); i++) {
-		if ((fFifthCycle[i].second == ialter) && (fFifthCycle[i].first == pitch)) {
-			i += tableshift;
-			if (i > fFifthCycle.size()) i -= 12;
-			else if (i < 0) i += 12;
+	int i = fifthIndex (pitch, ialter);
+	if (i < 0) {
+		cerr << "transpose: pitch out of fifth cycle table (" << pitch << " " << ialter << ")" << endl;
+		return;
+	}
 
-			pitch = fFifthCycle[i].first;
-			alter = fFifthCycle[i].second + diff;
+	int pitch1 = notevisitor::step2i(pitch);
+	i += tableshift;
+	while (i >= kFifthCycleSize) i -= 12;
+	while (i < 0) i += 12;
 
-			int pitch2 = notevisitor::step2i(pitch);
-			if ((pitch2 < pitch1) && (fChromaticSteps > 0)) octave++;
-			else if ((pitch2 > pitch1) && (fChromaticSteps < 0)) octave--;
+	pitch = kFifthCycle[i % kStepsCount];
+	alter = (i / kStepsCount) - kMaxAlter + diff;
 
-			return;
-		}
-	}
-	cerr << "transpose: pitch out of fifth cycle table (" << pitch << " " << ialter << ")" << endl;
+	int pitch2 = notevisitor::step2i(pitch);
+	if ((pitch2 < pitch1) && (fChromaticSteps > 0)) octave++;
+	else if ((pitch2 > pitch1) && (fChromaticSteps < 0)) octave--;
 }
 
 //________________________________________________________________________
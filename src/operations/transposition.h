@@ -53,15 +53,11 @@ class EXP transposition :
     protected:		
 		Chromatic	fChromaticSteps;			// the target transposing interval
 
-		std::vector<pair<std::string,int> >	fFifthCycle;	// the fifth cycle table
-
 		int		fTableShift;			// the current shift into the table of fifths
 		int		fOctaveChange;			// the target octave change computed from fChromaticSteps
 		int		fKeySign;				// the target key signature 
 		int		fCurrentKeySign;		// the current key signature
 
-		void	initialize	();
-
 		/*! Create a support element
 			\param elt the target element name
 			\param val a boolean denoting support
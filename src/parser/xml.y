@@ -29,6 +29,7 @@ int		libmxmlwrap();
 bool	readfile   (const char * file, reader * r);
 bool	readstream (FILE * file, reader * r);
 bool	readbuffer (const char * buffer, reader * r);
+bool	readsource (lexsource source, void * data, reader * r);
 #ifdef __cplusplus
 }
 #endif
@@ -191,7 +192,7 @@ bool readfile (const char * file, reader * r)
 		return false;
 	}
 	init(r);
-	libmxmlrestart(fd);
+	lexinit(fd);
 	libmxmlin = fd;
  	int ret = yyparse();
  	fclose (fd);
@@ -203,13 +204,27 @@ bool readstream (FILE * fd, reader * r)
 {
 	if (!fd) return false;
 	init(r);
-	libmxmlrestart(fd);
+	lexinit(fd);
 	libmxmlin = fd;
  	int ret = yyparse();
 	BEGIN(INITIAL);
  	return ret==0;
 }
 
+// reads from a source function, the input file is not used
+bool readsource (lexsource source, void * data, reader * r) 
+{
+	if (!source) return false;
+	init(r);
+	lexsetsource (source, data);
+	libmxmlrestart(stdin);
+	libmxmlin = stdin;
+ 	int ret = yyparse();
+	lexsetsource (0, 0);
+	BEGIN(INITIAL);
+ 	return ret==0;
+}
+
 void	yyerror(const char *s)	{ gReader->error (s, libmxmllineno); }
 
 #ifdef MAIN
@@ -764,8 +764,10 @@ char *libmxmltext;
 
 #include "xmlparse.hpp"
 #include <stdio.h>
+#include "profiler.h"
 
 #define YY_NO_UNISTD_H
+#define YY_USER_ACTION	PROFILE_COUNT(MusicXML2::kBytesLexed, yyleng);
 
 extern int libmxmllval;
 
@@ -773,22 +775,44 @@ static int utf16 = 0;
 static int bigendian = 1;
 static int start = 1;
 
+/* an optional input source, used in place of the input file */
+typedef size_t (*lexsource) (void * data, char * buf, size_t size);
+static lexsource source = 0;
+static void * sourcedata = 0;
+static char sourcebuf[4096];
+static size_t sourcelen = 0;
+static size_t sourcepos = 0;
+static int sourceend = 0;
+
+static int sgetc(FILE * fd) {
+	if (!source) return getc(fd);
+	if (sourcepos == sourcelen) {
+		sourcelen = sourceend ? 0 : source (sourcedata, sourcebuf, sizeof(sourcebuf));
+		sourcepos = 0;
+		if (!sourcelen) {
+			sourceend = 1;
+			return EOF;
+		}
+	}
+	return (unsigned char)sourcebuf[sourcepos++];
+}
+
 static int wgetc(FILE * fd) {
-	int c = getc(fd);
+	int c = sgetc(fd);
 	if (start) {
 		if (c == 0xff) {
 			utf16 = 1; bigendian = 0;
-			getc(fd); c = getc(fd);
+			sgetc(fd); c = sgetc(fd);
 		}
 		else if (c == 0xfe) {
 			utf16 = 1; bigendian = 1;
-			getc(fd); c = getc(fd);
+			sgetc(fd); c = sgetc(fd);
 		}
 		start = 0;
 	}
 	if (utf16) {
-		if (bigendian) c = getc(fd);
-		else getc(fd);
+		if (bigendian) c = sgetc(fd);
+		else sgetc(fd);
 	}
 
 	return c;
@@ -799,7 +823,7 @@ static size_t wfread (void * buf, size_t size, size_t nmemb, FILE * fd) {
 	size_t n=0;
 	while (nmemb--) {
 		*ptr++ = wgetc(fd);
-		if (feof(fd) || ferror(fd) ) break;
+		if (source ? sourceend : (feof(fd) || ferror(fd)) ) break;
 		n++;
 	}
 	return n;
@@ -811,6 +835,16 @@ void lexinit(FILE* fd) {
 	start = 1;
 	libmxmlrestart(fd);
 }
+
+void lexsetsource(lexsource s, void * data) {
+	source = s;
+	sourcedata = data;
+	sourcelen = sourcepos = 0;
+	sourceend = 0;
+	utf16 = 0;
+	bigendian = 1;
+	start = 1;
+}
 		 
 void lexend() {
 	if (YY_CURRENT_BUFFER) {
@@ -823,7 +857,7 @@ void lexend() {
 #define register		// to get rid of the -Wdeprecated-register
 
 
-#line 827 "xmllex.c++"
+#line 861 "xmllex.c++"
 
 #define INITIAL 0
 #define COMMENTSECT 1
@@ -1008,11 +1042,11 @@ YY_DECL
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
     
-#line 92 "xml.l"
+#line 126 "xml.l"
 
 
 
-#line 1016 "xmllex.c++"
+#line 1050 "xmllex.c++"
 
 	if ( !(yy_init) )
 		{
@@ -1104,142 +1138,142 @@ do_action:	/* This label is used only to access EOF actions. */
 case 1:
 /* rule 1 can match eol */
 YY_RULE_SETUP
-#line 95 "xml.l"
+#line 129 "xml.l"
 { BEGIN COMMENTSECT; }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 96 "xml.l"
+#line 130 "xml.l"
 { BEGIN 0; }
 	YY_BREAK
 case 3:
 /* rule 3 can match eol */
 YY_RULE_SETUP
-#line 97 "xml.l"
+#line 131 "xml.l"
 { return COMMENT; }
 	YY_BREAK
 case 4:
 /* rule 4 can match eol */
 YY_RULE_SETUP
-#line 100 "xml.l"
+#line 134 "xml.l"
 { BEGIN XMLSECT; return XMLDECL; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 101 "xml.l"
+#line 135 "xml.l"
 { BEGIN 0; return ENDXMLDECL; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 102 "xml.l"
+#line 136 "xml.l"
 { return VERSION; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 103 "xml.l"
+#line 137 "xml.l"
 { return ENCODING; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 104 "xml.l"
+#line 138 "xml.l"
 { return STANDALONE; }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 105 "xml.l"
+#line 139 "xml.l"
 { libmxmllval=1; return YES; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 106 "xml.l"
+#line 140 "xml.l"
 { libmxmllval=0; return NO; }
 	YY_BREAK
 case 11:
 /* rule 11 can match eol */
 YY_RULE_SETUP
-#line 108 "xml.l"
+#line 142 "xml.l"
 { BEGIN PISECT; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 109 "xml.l"
+#line 143 "xml.l"
 { BEGIN 0; return PI; }
 	YY_BREAK
 case 13:
 /* rule 13 can match eol */
 YY_RULE_SETUP
-#line 110 "xml.l"
+#line 144 "xml.l"
 { return PI; }
 	YY_BREAK
 case 14:
 /* rule 14 can match eol */
 YY_RULE_SETUP
-#line 112 "xml.l"
+#line 146 "xml.l"
 { BEGIN DOCTYPESECT; return DOCTYPE; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 113 "xml.l"
+#line 147 "xml.l"
 { return PUBLIC; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 114 "xml.l"
+#line 148 "xml.l"
 { return SYSTEM; }
 	YY_BREAK
 case 17:
 /* rule 17 can match eol */
 YY_RULE_SETUP
-#line 116 "xml.l"
+#line 150 "xml.l"
 { BEGIN 0; return LT; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 117 "xml.l"
+#line 151 "xml.l"
 { BEGIN DATASECT; return GT; }
 	YY_BREAK
 case 19:
 /* rule 19 can match eol */
 YY_RULE_SETUP
-#line 118 "xml.l"
+#line 152 "xml.l"
 { BEGIN 0; return ENDXMLS; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 119 "xml.l"
+#line 153 "xml.l"
 { return ENDXMLE; }
 	YY_BREAK
 case 21:
 /* rule 21 can match eol */
 YY_RULE_SETUP
-#line 121 "xml.l"
+#line 155 "xml.l"
 { return SPACE; }
 	YY_BREAK
 case 22:
 /* rule 22 can match eol */
 YY_RULE_SETUP
-#line 122 "xml.l"
+#line 156 "xml.l"
 { return DATA; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 123 "xml.l"
+#line 157 "xml.l"
 { return NAME; }
 	YY_BREAK
 case 24:
 /* rule 24 can match eol */
 YY_RULE_SETUP
-#line 124 "xml.l"
+#line 158 "xml.l"
 { return QUOTEDSTR; }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 125 "xml.l"
+#line 159 "xml.l"
 { return EQ; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 127 "xml.l"
+#line 161 "xml.l"
 { /* extra space ignored*/ }
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
@@ -1248,15 +1282,15 @@ case YY_STATE_EOF(DATASECT):
 case YY_STATE_EOF(XMLSECT):
 case YY_STATE_EOF(PISECT):
 case YY_STATE_EOF(DOCTYPESECT):
-#line 129 "xml.l"
+#line 163 "xml.l"
 yyterminate();
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 130 "xml.l"
+#line 164 "xml.l"
 ECHO;
 	YY_BREAK
-#line 1260 "xmllex.c++"
+#line 1294 "xmllex.c++"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -2219,4 +2253,4 @@ void libmxmlfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 130 "xml.l"
+#line 164 "xml.l"
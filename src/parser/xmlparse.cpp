@@ -156,6 +156,7 @@ int		libmxmlwrap();
 bool	readfile   (const char * file, reader * r);
 bool	readstream (FILE * file, reader * r);
 bool	readbuffer (const char * buffer, reader * r);
+bool	readsource (lexsource source, void * data, reader * r);
 #ifdef __cplusplus
 }
 #endif
@@ -244,7 +245,7 @@ typedef int YYSTYPE;
 
 
 /* Line 216 of yacc.c.  */
-#line 248 "xmlparse.cpp"
+#line 249 "xmlparse.cpp"
 
 #ifdef short
 # undef short
@@ -1500,103 +1501,103 @@ yyreduce:
   switch (yyn)
     {
         case 11:
-#line 115 "xml.y"
+#line 116 "xml.y"
     { if (!gReader->endElement(eltName)) ERROR("end element error") ;}
     break;
 
   case 12:
-#line 116 "xml.y"
+#line 117 "xml.y"
     { if (!gReader->endElement(eltName)) ERROR("end element error") ;}
     break;
 
   case 13:
-#line 118 "xml.y"
+#line 119 "xml.y"
     { store(eltName, libmxmltext); if (!gReader->newElement(libmxmltext)) ERROR("element error") ;}
     break;
 
   case 14:
-#line 119 "xml.y"
+#line 120 "xml.y"
     { if (!gReader->endElement(libmxmltext)) ERROR("end element error") ;}
     break;
 
   case 15:
-#line 121 "xml.y"
+#line 122 "xml.y"
     { if (!gReader->newAttribute (attributeName, attributeVal)) ERROR("attribute error") ;}
     break;
 
   case 16:
-#line 122 "xml.y"
+#line 123 "xml.y"
     { store(attributeName, libmxmltext); ;}
     break;
 
   case 17:
-#line 123 "xml.y"
+#line 124 "xml.y"
     { store(attributeVal, unquote(libmxmltext)); ;}
     break;
 
   case 23:
-#line 132 "xml.y"
+#line 133 "xml.y"
     { gReader->setValue (libmxmltext); ;}
     break;
 
   case 24:
-#line 134 "xml.y"
+#line 135 "xml.y"
     { gReader->newProcessingInstruction (libmxmltext); ;}
     break;
 
   case 25:
-#line 135 "xml.y"
+#line 136 "xml.y"
     { gReader->newComment (libmxmltext); ;}
     break;
 
   case 29:
-#line 142 "xml.y"
+#line 143 "xml.y"
     { if (!gReader->xmlDecl (xmlversion, xmlencoding, xmlStandalone)) ERROR("xmlDecl error") ;}
     break;
 
   case 34:
-#line 149 "xml.y"
+#line 150 "xml.y"
     { store(xmlversion, unquote(libmxmltext)); ;}
     break;
 
   case 35:
-#line 150 "xml.y"
+#line 151 "xml.y"
     { store(xmlencoding, unquote(libmxmltext)); ;}
     break;
 
   case 36:
-#line 151 "xml.y"
+#line 152 "xml.y"
     { xmlStandalone = yylval; ;}
     break;
 
   case 40:
-#line 155 "xml.y"
+#line 156 "xml.y"
     { store(doctypeStart, libmxmltext); ;}
     break;
 
   case 41:
-#line 156 "xml.y"
+#line 157 "xml.y"
     { gReader->docType (doctypeStart, true, doctypePub, doctypeSys); ;}
     break;
 
   case 42:
-#line 157 "xml.y"
+#line 158 "xml.y"
     { gReader->docType (doctypeStart, false, doctypePub, doctypeSys); ;}
     break;
 
   case 43:
-#line 158 "xml.y"
+#line 159 "xml.y"
     { store(doctypePub, unquote(libmxmltext)); ;}
     break;
 
   case 44:
-#line 159 "xml.y"
+#line 160 "xml.y"
     { store(doctypeSys, unquote(libmxmltext)); ;}
     break;
 
 
 /* Line 1267 of yacc.c.  */
-#line 1600 "xmlparse.cpp"
+#line 1601 "xmlparse.cpp"
       default: break;
     }
   YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
@@ -1810,7 +1811,7 @@ yyreturn:
 }
 
 
-#line 165 "xml.y"
+#line 166 "xml.y"
 
 
 #define yy_delete_buffer	libmxml_delete_buffer
@@ -1840,7 +1841,7 @@ bool readfile (const char * file, reader * r)
 		return false;
 	}
 	init(r);
-	libmxmlrestart(fd);
+	lexinit(fd);
 	libmxmlin = fd;
  	int ret = yyparse();
  	fclose (fd);
@@ -1852,13 +1853,27 @@ bool readstream (FILE * fd, reader * r)
 {
 	if (!fd) return false;
 	init(r);
-	libmxmlrestart(fd);
+	lexinit(fd);
 	libmxmlin = fd;
  	int ret = yyparse();
 	BEGIN(INITIAL);
  	return ret==0;
 }
 
+// reads from a source function, the input file is not used
+bool readsource (lexsource source, void * data, reader * r) 
+{
+	if (!source) return false;
+	init(r);
+	lexsetsource (source, data);
+	libmxmlrestart(stdin);
+	libmxmlin = stdin;
+ 	int ret = yyparse();
+	lexsetsource (0, 0);
+	BEGIN(INITIAL);
+ 	return ret==0;
+}
+
 void	yyerror(const char *s)	{ gReader->error (s, libmxmllineno); }
 
 #ifdef MAIN
@@ -96,6 +96,13 @@ midicontextvisitor::midicontextvisitor(long tpq, midiwriter* writer)
     fDivisions = 1; // to be checked
 }
 
+//________________________________________________________________________
+midicontextvisitor::midicontextvisitor(const midicontextvisitor& context, midiwriter* writer)
+{
+	*this = context;
+	fMidiWriter = writer;
+}
+
 //________________________________________________________________________
 void midicontextvisitor::addDuration(long dur)
 {
@@ -155,7 +162,7 @@ void midicontextvisitor::playNote (const notevisitor& note)
 
 	if (fMidiWriter && (t != notevisitor::kRest)) {
 		int chan = fCurrentChan;
-		float pitch = note.getMidiPitch() + fTranspose;
+		float pitch = note.getMidiKey();
 		if (pitch >= 0) pitch += fTranspose;
 
 		// check for instrument specification
@@ -166,7 +173,7 @@ void midicontextvisitor::playNote (const notevisitor& note)
 				// to retrieve the midi channel
 				chan =  mi.fChan;				// get MIDI channel
 				if ((mi.fUnpitched >= 0) || (t == notevisitor::kUnpitched))
-					pitch = (float)mi.fUnpitched;		// and optionaly get unpitched data
+					pitch = (float)mi.fUnpitched - 1;	// and optionaly get unpitched data (numbered from 1 to 128)
 			}
 		}
 		if (pitch < 0) pitch = 60;
@@ -180,10 +187,10 @@ void midicontextvisitor::playNote (const notevisitor& note)
 			dur = fTPQ / 6;			// have no duration - set to an arbitrary value
 			date -= dur;			// and play in advance
 			if (date < 0) date = 0; // check for negative dates
-			fMidiWriter->newNote(date, chan, note.getMidiPitch(), vel, dur);
+			fMidiWriter->newNote(date, chan, pitch, vel, dur);
 		}
 		else if (tie == StartStop::undefined) {
-			fMidiWriter->newNote(date, chan, note.getMidiPitch(), vel, dur);
+			fMidiWriter->newNote(date, chan, pitch, vel, dur);
 		}
 		else if (tie & StartStop::start) {
 			fPendingDuration += dur;
@@ -191,7 +198,7 @@ void midicontextvisitor::playNote (const notevisitor& note)
 		}
 		else if (tie == StartStop::stop) {
 			dur += fPendingDuration;
-			fMidiWriter->newNote(date, chan, note.getMidiPitch(), vel, dur);
+			fMidiWriter->newNote(date, chan, pitch, vel, dur);
 			fPendingDuration = 0;
 		}
 	}
@@ -298,10 +305,10 @@ void midicontextvisitor::visitStart ( S_sound& elt )
 	if (attr) playTempoChange( long(*attr) );
 
 	attr = elt->getAttribute("damper-pedal");
-	if (attr) playPedalChange( midiwriter::kSostenutoPedal, attr->getValue() );
+	if (attr) playPedalChange( midiwriter::kDamperPedal, attr->getValue() );
 
 	attr = elt->getAttribute("soft-pedal");
-	if (attr) playPedalChange( midiwriter::kSostenutoPedal, attr->getValue() );
+	if (attr) playPedalChange( midiwriter::kSoftpedal, attr->getValue() );
 
 	attr = elt->getAttribute("sostenuto-pedal");
 	if (attr) playPedalChange( midiwriter::kSostenutoPedal, attr->getValue() );
@@ -190,6 +190,10 @@ class EXP midicontextvisitor :
 
     public:    
 				 midicontextvisitor(long tpq, midiwriter* writer=0);
+				 /*! creates a visitor that inherits the context of another visitor 
+				 	(e.g. the score header information) but uses a different writer.
+				 */
+				 midicontextvisitor(const midicontextvisitor& context, midiwriter* writer);
        	virtual ~midicontextvisitor();
 };
 
@@ -127,6 +127,13 @@ float notevisitor::getMidiPitch() const
     return -1;
 }
 
+//________________________________________________________________________
+float notevisitor::getMidiKey() const
+{
+	float pitch = getMidiPitch();
+	return (pitch >= 0) ? pitch + 12 : pitch;
+}
+
 //________________________________________________________________________
 void notevisitor::visitStart ( S_time_modification& elt )
 {
@@ -115,11 +115,17 @@ class EXP notevisitor :
 
 		/*!
 		\brief Compute the note MIDI pitch.
-		\return The note MIDI pitch as a float value. 
+		\return The note MIDI pitch as a float value (middle C is 48). 
 		Decimal part of the value represents fine pitch and may be used to drive pitch bend messages.
 		Returns -1 for non pitched notes.
 		*/
         virtual float	getMidiPitch() const;
+		/*!
+		\brief Compute the note MIDI key number, following the MIDI convention.
+		\return The note MIDI pitch as a float value, one octave above getMidiPitch() (middle C is 60).
+		Returns -1 for non pitched notes.
+		*/
+        virtual float	getMidiKey() const;
         virtual float	getAlter() const	{ return fAlter; }
         virtual int		getOctave() const	{ return fOctave; }
 
@@ -0,0 +1,219 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef VC6
+# pragma warning (disable : 4786)
+#endif
+
+#include <algorithm>
+
+#include "clefvisitor.h"
+#include "keysignvisitor.h"
+#include "scorecontext.h"
+#include "timesignvisitor.h"
+#include "transposevisitor.h"
+#include "xml_tree_browser.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// a visitor that collects the attributes changes and the measures dates
+//______________________________________________________________________________
+class scorecontextvisitor :
+	public clefvisitor,
+	public keysignvisitor,
+	public timesignvisitor,
+	public transposevisitor,
+	public visitor<S_part>,
+	public visitor<S_measure>,
+	public visitor<S_divisions>,
+	public visitor<S_note>,
+	public visitor<S_backup>,
+	public visitor<S_forward>
+{
+	public:
+				 scorecontextvisitor(vector<scorecontext::partindex>& parts)
+					: fParts(parts), fDivisions(1) {}
+		virtual ~scorecontextvisitor() {}
+
+	protected:
+		vector<scorecontext::partindex>& fParts;
+		long		fDivisions;
+		rational	fMeasureStart;		// the current measure date
+		rational	fPosition;			// the current position in the measure
+		rational	fMeasureLength;		// the greatest position reached in the measure
+
+		scorecontext::partindex& current ()		{ return fParts.back(); }
+		rational	date () const				{ rational d = fMeasureStart + fPosition; d.rationalise(); return d; }
+		rational	duration (long dur) const	{ rational r(dur, fDivisions * 4); r.rationalise(); return r; }
+
+		void move (const rational& dur) {
+			fPosition += dur;
+			fPosition.rationalise();
+			if (fPosition < rational(0,1)) fPosition.set(0,1);
+			if (fMeasureLength < fPosition) fMeasureLength = fPosition;
+		}
+
+		template <typename T> void add (scorecontext::changes<T>& list, const T& value) {
+			scorecontext::change<T> c;
+			c.fDate = date();
+			c.fValue = value;
+			list.push_back (c);
+		}
+
+		virtual void visitStart( S_part& elt ) {
+			fParts.push_back (scorecontext::partindex());
+			current().fID = elt->getAttributeValue("id");
+			fDivisions = 1;
+			fMeasureStart.set(0,1);
+		}
+		virtual void visitStart( S_measure& elt ) {
+			current().fMeasures.push_back (fMeasureStart);
+			fPosition.set(0,1);
+			fMeasureLength.set(0,1);
+		}
+		virtual void visitEnd( S_measure& elt ) {
+			fMeasureStart += fMeasureLength;
+			fMeasureStart.rationalise();
+		}
+		virtual void visitStart( S_divisions& elt ) {
+			long div = long(*elt);
+			if (div > 0) {
+				fDivisions = div;
+				add (current().fDivisions, div);
+			}
+		}
+		virtual void visitStart( S_note& elt ) {
+			bool chord = false, grace = false;
+			long dur = 0;
+			ctree<xmlelement>::literator i;
+			for (i = elt->lbegin(); i != elt->lend(); i++) {
+				switch ((*i)->getType()) {
+					case k_chord:		chord = true; break;
+					case k_grace:		grace = true; break;
+					case k_duration:	dur = long(**i); break;
+				}
+			}
+			if (!chord && !grace) move (duration(dur));
+		}
+		virtual void visitStart( S_backup& elt )	{ move (rational(0,1) - duration(elt->getIntValue(k_duration, 0))); }
+		virtual void visitStart( S_forward& elt )	{ move (duration(elt->getIntValue(k_duration, 0))); }
+
+		virtual void visitEnd( S_clef& elt ) {
+			scorecontext::clef c = { fSign, fLine, clefvisitor::fOctaveChange };
+			add (current().fClefs[(fNumber == kNoNumber) ? 1 : fNumber], c);
+		}
+		virtual void visitEnd( S_key& elt ) {
+			scorecontext::key k = { fFifths, fCancel, fMode };
+			int staff = elt->getAttributeIntValue("number", scorecontext::kAllStaves);
+			add (current().fKeys[staff], k);
+		}
+		virtual void visitEnd( S_time& elt ) {
+			scorecontext::time t = { fTimeSign, fSymbol, fSenzaMisura };
+			add (current().fTimes[(fStaffNumber == kNoStaffNumber) ? int(scorecontext::kAllStaves) : fStaffNumber], t);
+		}
+		virtual void visitEnd( S_transpose& elt ) {
+			scorecontext::transpose t = { fDiatonic, fChromatic, transposevisitor::fOctaveChange, fDouble };
+			add (current().fTransposes, t);
+		}
+};
+
+//______________________________________________________________________________
+// scorecontext
+//______________________________________________________________________________
+template <typename T> static bool before (const scorecontext::change<T>& c1, const scorecontext::change<T>& c2)
+	{ return c1.fDate < c2.fDate; }
+
+// changes are collected in the score order, which is not the dates order when
+// the score includes backup elements
+template <typename T> static void sort (scorecontext::changes<T>& list)
+	{ stable_sort (list.begin(), list.end(), before<T>); }
+
+template <typename T> static void sort (map<int, scorecontext::changes<T> >& list)
+{
+	for (typename map<int, scorecontext::changes<T> >::iterator i = list.begin(); i != list.end(); i++)
+		sort (i->second);
+}
+
+void scorecontext::build (const Sxmlelement& score)
+{
+	clear();
+	scorecontextvisitor v (fParts);
+	xml_tree_browser browser(&v);
+	browser.browse (*score);
+
+	for (vector<partindex>::iterator i = fParts.begin(); i != fParts.end(); i++) {
+		sort (i->fClefs);
+		sort (i->fKeys);
+		sort (i->fTimes);
+		sort (i->fTransposes);
+		sort (i->fDivisions);
+	}
+}
+
+//______________________________________________________________________________
+int scorecontext::part (const std::string& id) const
+{
+	for (size_t i = 0; i < fParts.size(); i++)
+		if (fParts[i].fID == id) return int(i);
+	return -1;
+}
+
+//______________________________________________________________________________
+rational scorecontext::measureDate (int part, int measure) const
+{
+	const vector<rational>& measures = fParts[part].fMeasures;
+	if ((measure < 0) || (measure >= int(measures.size()))) return rational(-1,1);
+	return measures[measure];
+}
+
+int scorecontext::measureAt (int part, const rational& date) const
+{
+	const vector<rational>& measures = fParts[part].fMeasures;
+	if (measures.empty() || (date < rational(0,1))) return -1;
+	return int(upper_bound (measures.begin(), measures.end(), date) - measures.begin()) - 1;
+}
+
+//______________________________________________________________________________
+// looks for the last change of a staff, including the changes that apply to all the staves
+template <typename T> const T* scorecontext::lookup (const map<int, changes<T> >& list, int staff, const rational& date)
+{
+	const change<T>* c = 0;
+	typename map<int, changes<T> >::const_iterator i = list.find (staff);
+	if (i != list.end()) c = i->second.find (date);
+	if (staff != kAllStaves) {
+		i = list.find (kAllStaves);
+		const change<T>* all = (i != list.end()) ? i->second.find (date) : 0;
+		if (all && (!c || (c->fDate < all->fDate))) c = all;
+	}
+	return c ? &c->fValue : 0;
+}
+
+const scorecontext::clef* scorecontext::clefAt (int part, int staff, const rational& date) const
+	{ return lookup (fParts[part].fClefs, staff, date); }
+const scorecontext::key* scorecontext::keyAt (int part, int staff, const rational& date) const
+	{ return lookup (fParts[part].fKeys, staff, date); }
+const scorecontext::time* scorecontext::timeAt (int part, int staff, const rational& date) const
+	{ return lookup (fParts[part].fTimes, staff, date); }
+const scorecontext::transpose* scorecontext::transposeAt (int part, const rational& date) const
+	{ return fParts[part].fTransposes.at (date); }
+
+long scorecontext::divisionsAt (int part, const rational& date) const
+{
+	const long* div = fParts[part].fDivisions.at (date);
+	return div ? *div : 0;
+}
+
+}
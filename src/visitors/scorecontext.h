@@ -0,0 +1,150 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __scorecontext__
+#define __scorecontext__
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exports.h"
+#include "rational.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup visitors
+@{
+*/
+
+//______________________________________________________________________________
+/*!
+\brief An index of the attributes state of a score.
+
+	The index is built in a single pass: it records, for each part, the changes of
+	clef, key, time signature, divisions and transposition, in sorted tables.
+	The state in effect at any date is then an O(log n) lookup, which allows to
+	start a process anywhere in the score without replaying it from the start.
+
+	Dates are expressed in whole notes from the beginning of the part, a measure
+	start date is given by measureDate(). The changes at a given date are part of
+	the state at this date. Clefs, keys and time signatures are indexed by staff:
+	elements without \b number attribute apply to all the staves, except clefs which
+	apply to the first staff. Lookups return a null pointer when there is no element
+	before the given date.
+	The score is not unrolled: the dates are in the score order.
+*/
+class EXP scorecontext
+{
+	public:
+		typedef struct {
+			std::string	fSign;
+			int			fLine;
+			int			fOctaveChange;
+		} clef;
+
+		typedef struct {
+			int			fFifths;
+			int			fCancel;
+			std::string	fMode;
+		} key;
+
+		typedef struct {
+			std::vector<std::pair<std::string,std::string> > fTimeSign;	///< the beats and beat-type pairs
+			std::string	fSymbol;
+			bool		fSenzaMisura;
+		} time;
+
+		typedef struct {
+			int		fDiatonic;
+			int		fChromatic;
+			int		fOctaveChange;
+			bool	fDouble;
+		} transpose;
+
+		template <typename T> struct change {
+			rational	fDate;
+			T			fValue;
+		};
+		//! a set of changes sorted by date
+		template <typename T> class changes : public std::vector<change<T> > {
+			public:
+				//! gives the last change at or before a date, null when the first change is after the date
+				const change<T>* find (const rational& date) const {
+					size_t low = 0, high = this->size();
+					while (low < high) {
+						size_t mid = (low + high) / 2;
+						if (date < (*this)[mid].fDate) high = mid;
+						else low = mid + 1;
+					}
+					return low ? &(*this)[low-1] : 0;
+				}
+				//! gives the value in effect at a date, null when the first change is after the date
+				const T* at (const rational& date) const	{ const change<T>* c = find(date); return c ? &c->fValue : 0; }
+		};
+
+				 scorecontext() {}
+		virtual ~scorecontext() {}
+
+		//! builds the index of a partwise score
+		void	build (const Sxmlelement& score);
+		void	clear ()								{ fParts.clear(); }
+
+		//! gives the parts count
+		int					parts () const				{ return int(fParts.size()); }
+		//! gives a part index, -1 when not found
+		int					part (const std::string& id) const;
+		const std::string&	partID (int part) const		{ return fParts[part].fID; }
+
+		//! gives the measures count of a part
+		int			measures (int part) const			{ return int(fParts[part].fMeasures.size()); }
+		//! gives the start date of a measure, given its index in the part
+		rational	measureDate (int part, int measure) const;
+		//! gives the index of the measure at a date (the last one when measures are empty), -1 when out of the part
+		int			measureAt (int part, const rational& date) const;
+
+		const clef*			clefAt (int part, int staff, const rational& date) const;
+		const key*			keyAt (int part, int staff, const rational& date) const;
+		const time*			timeAt (int part, int staff, const rational& date) const;
+		const transpose*	transposeAt (int part, const rational& date) const;
+		//! gives the divisions in effect at a date, 0 when unknown
+		long				divisionsAt (int part, const rational& date) const;
+
+	protected:
+		friend class scorecontextvisitor;
+
+		enum { kAllStaves = 0 };
+
+		typedef struct {
+			std::string									fID;
+			std::vector<rational>						fMeasures;	///< the measures start dates
+			std::map<int, changes<clef> >				fClefs;		///< the clefs changes by staff
+			std::map<int, changes<key> >				fKeys;		///< the keys changes by staff, kAllStaves for all the staves
+			std::map<int, changes<time> >				fTimes;		///< the time signatures changes by staff, kAllStaves for all the staves
+			changes<transpose>							fTransposes;
+			changes<long>								fDivisions;
+		} partindex;
+
+		std::vector<partindex>	fParts;
+
+		template <typename T> static const T* lookup (const std::map<int, changes<T> >& map, int staff, const rational& date);
+};
+
+/*! @} */
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 */
 
 #include <iostream>
+#include <sstream>
 #include "xmlvisitor.h"
 
 using namespace std;
@@ -32,33 +33,95 @@ void xmlendl::print(std::ostream& os) const {
     while (i-- > 0)  os << "    ";
 }
 
+//______________________________________________________________________________
+// the cached elements: the measures and the top level elements other than the parts
+bool xmlvisitor::cached ( const Sxmlelement& elt ) const
+{
+	if (!elt->size()) return false;			// the leaves are printed directly
+	int type = elt->getType();
+	return (type == k_measure) || ((fDepth == 1) && (type != k_part));
+}
+
+//______________________________________________________________________________
+// the entries of the elements printed are moved to a new table, which replaces
+// the cache at the end of the print: the entries of the removed elements are dropped
+void xmlvisitor::print ( const Sxmlelement& elt )
+{
+	printElement (elt);
+	if (fCache && !fDepth) {
+		fCache->fEntries.swap (fPrinted);
+		fPrinted.clear();
+	}
+}
+
+void xmlvisitor::printElement ( const Sxmlelement& elt )
+{
+	int indent = fendl.indent();
+	bool store = fCache && cached (elt);
+	if (store && !elt->modified()) {
+		xmlprintcache::entries::iterator i = fCache->fEntries.find (elt);
+		if ((i != fCache->fEntries.end()) && (i->second.fIndent == indent)) {
+			*fOut << i->second.fText;
+			fPrinted[elt].fText.swap (i->second.fText);
+			fPrinted[elt].fIndent = indent;
+			return;
+		}
+	}
+
+	bool shared = fShared;
+	fShared = false;
+	ostream* out = fOut;
+	ostringstream text;
+	if (store) fOut = &text;
+	fDepth++;
+	elt->acceptIn (*this);
+	for (ctree<xmlelement>::literator i = elt->lbegin(); i != elt->lend(); i++) {
+		if ((*i)->parent() != (xmlelement*)elt) fShared = true;
+		printElement (*i);
+	}
+	elt->acceptOut (*this);
+	fDepth--;
+	if (store) {
+		fOut = out;
+		string str = text.str();
+		*fOut << str;
+		if (!fShared) {
+			xmlprintcache::entry& e = fPrinted[elt];
+			e.fText.swap (str);
+			e.fIndent = indent;
+		}
+	}
+	if (fCache) elt->setClean();
+	fShared = shared || fShared;
+}
+
 //______________________________________________________________________________
 void xmlvisitor::visitStart ( S_comment& elt ) 
 {
-	fOut <<  fendl << "<!--" << elt->getValue() << "-->";
+	*fOut <<  fendl << "<!--" << elt->getValue() << "-->";
 }
 
 //______________________________________________________________________________
 void xmlvisitor::visitStart ( S_processing_instruction& elt ) 
 {
-	fOut <<  fendl << "<?" << elt->getValue() << "?>";
+	*fOut <<  fendl << "<?" << elt->getValue() << "?>";
 }
 
 //______________________________________________________________________________
 void xmlvisitor::visitStart ( Sxmlelement& elt ) 
 {
-	fOut <<  fendl << "<" << elt->getName();
+	*fOut <<  fendl << "<" << elt->getName();
 	// print the element attributes first
 	vector<Sxmlattribute>::const_iterator attr; 
 	for (attr = elt->attributes().begin(); attr != elt->attributes().end(); attr++)
-		fOut << " " << (*attr)->getName() << "=\"" << (*attr)->getValue() << "\"";				
+		*fOut << " " << (*attr)->getName() << "=\"" << (*attr)->getValue() << "\"";				
 	if (elt->empty()) {
-		fOut << "/>";	// element is empty, we can direclty close it
+		*fOut << "/>";	// element is empty, we can direclty close it
 	}
 	else {
-		fOut << ">";
+		*fOut << ">";
 		if (!elt->getValue().empty())
-			fOut << elt->getValue();
+			*fOut << elt->getValue();
 		if (elt->size())
 			fendl++;
 	}
@@ -70,9 +133,9 @@ void xmlvisitor::visitEnd ( Sxmlelement& elt )
 	if (!elt->empty()) {
 		if (elt->size()) {
 			fendl--;
-			fOut << fendl;
+			*fOut << fendl;
 		}
-		fOut << "</" << elt->getName() << ">";
+		*fOut << "</" << elt->getName() << ">";
 	}
 }
 
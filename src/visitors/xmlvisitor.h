@@ -14,6 +14,8 @@
 #define __xmlvisitors__
 
 #include <ostream>
+#include <string>
+#include <unordered_map>
 
 #include "tree_browser.h"
 #include "typedefs.h"
@@ -40,24 +42,66 @@ class xmlendl {
 		xmlendl& operator++ (int)  { fIndent++; return *this; }
 		//! decrease the indentation
 		xmlendl& operator-- (int)  { fIndent--; return *this; }
+		//! gives the current indentation
+		int indent() const		{ return fIndent; }
 		//! reset the indentation to none
 		void print(std::ostream& os) const;
 };
 std::ostream& operator<< (std::ostream& os, const xmlendl& eol);
 
 //______________________________________________________________________________
+/*!
+\brief the text of the elements printed with a cache (see xmlvisitor).
+*/
+class EXP xmlprintcache
+{
+	public:
+		typedef struct {
+			std::string	fText;
+			int			fIndent;		///< the indentation the text has been printed with
+		} entry;
+		typedef std::unordered_map<const xmlelement*, entry>	entries;
+
+		entries		fEntries;
+};
+
+//______________________________________________________________________________
+/*!
+\brief the xml serialization visitor.
+
+	When a cache is given, print() keeps the text of the \b measure elements and
+	of the top level elements other than the parts, and clears the elements
+	modification state: the unmodified elements are then printed again from
+	their cached text. The cache holds about one copy of the document text, and
+	a change is rendered again at the measure level: caching every level would
+	speed up small changes but hold a copy of the text per level of the tree.
+	The cache keeps the elements of the last printed tree only, and a tree must
+	always be printed with the same cache.
+	The elements including an element whose parent is another element (a shared
+	element, see xmlelement) are not cached.
+*/
 class xmlvisitor : 
 	public visitor<S_comment>,
 	public visitor<S_processing_instruction>,
 	public visitor<Sxmlelement>
 {
-	std::ostream&	fOut;
+	std::ostream*	fOut;
 	xmlendl			fendl;
+	xmlprintcache*	fCache;
+	xmlprintcache::entries	fPrinted;	// the entries of the current print
+	int				fDepth;			// the depth of the printed element
+	bool			fShared;		// true when the printed element includes a shared element
+
+	bool			cached (const Sxmlelement& elt) const;
+	void			printElement (const Sxmlelement& elt);
 
     public:
-				 xmlvisitor(std::ostream& stream) : fOut(stream) {}
+				 xmlvisitor(std::ostream& stream, xmlprintcache* cache=0) : fOut(&stream), fCache(cache), fDepth(0), fShared(false) {}
 		virtual ~xmlvisitor() {}
 
+		//! prints an element and its sub-elements, using and updating the elements cache when enabled
+		void print ( const Sxmlelement& elt);
+
 		virtual void visitStart ( Sxmlelement& elt);
 		virtual void visitEnd   ( Sxmlelement& elt);
 		virtual void visitStart ( S_comment& elt);